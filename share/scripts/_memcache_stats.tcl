@@ -0,0 +1,60 @@
+namespace eval memcache_stats {
+
+set_help_text memcache_invalidation_rate \
+{Show how often the CPU memory cache gets invalidated, per device.
+
+Usage:
+  memcache_invalidation_rate [<seconds>]
+
+Samples 'machine_info memcache_invalidations' now and again after
+<seconds> (default 1) of emulated time, and then prints for each device
+(and for each page where slot switches caused invalidations) the number of
+invalidations and invalidated 256-byte cache lines per emulated second,
+busiest first. Mappers that are switched very often show up at the top.
+}
+
+proc delta {new old} {
+	# counters are 32-bit and wrap around
+	expr {($new - $old) & 0xFFFFFFFF}
+}
+
+proc report {before seconds} {
+	set after [machine_info memcache_invalidations]
+	set rows [list]
+	dict for {name counters} $after {
+		lassign $counters calls lines
+		lassign {0 0} calls0 lines0
+		if {[dict exists $before $name]} {
+			lassign [dict get $before $name] calls0 lines0
+		}
+		set calls [delta $calls $calls0]
+		if {$calls == 0} continue
+		set lines [delta $lines $lines0]
+		lappend rows [list $name [expr {$calls / $seconds}] [expr {$lines / $seconds}]]
+	}
+	if {[llength $rows] == 0} {
+		message "No memory cache invalidations in the last $seconds seconds."
+		return
+	}
+	set text [format "%-32s %14s %14s" "device" "invalidations/s" "lines/s"]
+	foreach row [lsort -real -decreasing -index 1 $rows] {
+		lassign $row name calls lines
+		append text "\n" [format "%-32s %14.1f %14.1f" $name $calls $lines]
+	}
+	message $text
+}
+
+proc memcache_invalidation_rate {{seconds 1}} {
+	if {$seconds <= 0} {
+		error "Sample period must be positive."
+	}
+	set before [machine_info memcache_invalidations]
+	after time $seconds [namespace code [list report $before $seconds]]
+	return "Sampling memory cache invalidations for $seconds seconds of emulated time..."
+}
+
+namespace export memcache_invalidation_rate
+
+} ;# namespace memcache_stats
+
+namespace import memcache_stats::*
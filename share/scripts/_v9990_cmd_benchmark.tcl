@@ -0,0 +1,148 @@
+namespace eval v9990_cmd_benchmark {
+
+set_help_text v9990_cmd_benchmark \
+{Measure how fast the V9990 (Graphics9000) command engine is emulated.
+
+Usage:
+  v9990_cmd_benchmark [<seconds>] [<workload> ...]
+
+The current machine must have a V9990 based extension (e.g. gfx9000)
+inserted. The benchmark switches the V9990 to a 256x212 8bpp bitmap mode,
+turns off throttling and keeps the command engine busy for <seconds>
+(default 10) of emulated time. Each time the engine becomes idle the next
+command of the selected workloads (default all) is started:
+  fill      LMMV of the full screen
+  copy      LMMM of a 64x64 block
+  tpcopy    LMMM of a 64x64 block with transparency
+  font      CMMM of a 64x64 monochrome block
+  linear    BMLL of 16kB
+When done, the number of executed commands and the emulation speed
+relative to real time are reported. Note that this modifies VRAM and the
+V9990 registers, so it's best run on a scratch machine.
+}
+
+variable regs
+variable workloads
+variable next
+variable count
+variable start_host
+variable start_emu
+variable old_throttle
+variable poll_id
+variable status_port 0x65 ;# status port of a V9990 mapped at 0x60
+
+proc find_regs_debuggable {} {
+	foreach name [debug list] {
+		if {[debug desc $name] eq "V9990 registers"} {
+			return $name
+		}
+	}
+	error "No V9990 found in the current machine."
+}
+
+proc set_reg16 {reg value} {
+	variable regs
+	debug write $regs $reg       [expr {$value & 0xFF}]
+	debug write $regs [expr {$reg + 1}] [expr {$value >> 8}]
+}
+
+proc start_command {sx sy dx dy nx ny log cmd} {
+	variable regs
+	set_reg16 32 $sx
+	set_reg16 34 $sy
+	set_reg16 36 $dx
+	set_reg16 38 $dy
+	set_reg16 40 $nx
+	set_reg16 42 $ny
+	debug write $regs 44 0     ;# ARG
+	debug write $regs 45 $log
+	set_reg16 46 0xFFFF        ;# write mask
+	set_reg16 48 [expr {int(rand() * 0x10000)}] ;# foreground color
+	set_reg16 50 0             ;# background color
+	debug write $regs 52 $cmd
+}
+
+proc random_pos {max} {
+	expr {int(rand() * $max)}
+}
+
+proc start_workload {name} {
+	switch $name {
+		fill   { start_command 0 0 0 0 256 212 0x0C 0x20 }
+		copy   { start_command 0 256 [random_pos 192] [random_pos 148] 64 64 0x0C 0x40 }
+		tpcopy { start_command 0 256 [random_pos 192] [random_pos 148] 64 64 0x1C 0x40 }
+		font   { start_command 0 256 [random_pos 192] [random_pos 148] 64 64 0x0C 0x70 }
+		linear { start_command 0 0x80 0 0 0 0x40 0x0C 0xA0 }
+	}
+}
+
+proc poll {} {
+	variable status_port
+	variable workloads
+	variable next
+	variable count
+	variable poll_id
+	if {([debug read ioports $status_port] & 0x01) == 0} {
+		start_workload [lindex $workloads $next]
+		set next [expr {($next + 1) % [llength $workloads]}]
+		incr count
+	}
+	set poll_id [after time 0.001 [namespace code poll]]
+}
+
+proc finish {} {
+	variable count
+	variable start_host
+	variable start_emu
+	variable old_throttle
+	variable poll_id
+	after cancel $poll_id
+	set ::throttle $old_throttle
+	set host [expr {([clock milliseconds] - $start_host) / 1000.0}]
+	set emu [expr {[machine_info time] - $start_emu}]
+	message [format "V9990 command benchmark: %d commands in %.2fs emulated time, took %.2fs, speed %.1fx real time" \
+		$count $emu $host [expr {$emu / $host}]]
+}
+
+proc v9990_cmd_benchmark {{seconds 10} args} {
+	variable regs
+	variable workloads
+	variable next
+	variable count
+	variable start_host
+	variable start_emu
+	variable old_throttle
+
+	set regs [find_regs_debuggable]
+	set all {fill copy tpcopy font linear}
+	if {[llength $args] == 0} {
+		set workloads $all
+	} else {
+		foreach w $args {
+			if {$w ni $all} {
+				error "Unknown workload: $w, must be one of: $all"
+			}
+		}
+		set workloads $args
+	}
+
+	# B1 mode: bitmap, 256 pixels wide image, 8bpp
+	debug write $regs 6 0x82
+	debug write $regs 7 0x00
+
+	set next 0
+	set count 0
+	set old_throttle $::throttle
+	set ::throttle off
+	set start_host [clock milliseconds]
+	set start_emu [machine_info time]
+	poll
+	after time $seconds [namespace code finish]
+	return "Running V9990 command benchmark for $seconds seconds of emulated time..."
+}
+
+namespace export v9990_cmd_benchmark
+
+} ;# namespace v9990_cmd_benchmark
+
+namespace import v9990_cmd_benchmark::*
@@ -17,6 +17,7 @@ register_lazy "_example_tools.tcl" {get_screen listing get_color_count toggle_tr
 register_lazy "_filepool.tcl" {filepool get_paths_for_type}
 register_lazy "_guess_title.tcl" {guess_title guess_rom_title guess_rom_device}
 register_lazy "_info_panel.tcl" toggle_info_panel
+register_lazy "_memcache_stats.tcl" memcache_invalidation_rate
 register_lazy "_metal_gear_overlay.tcl" {toggle_metal_gear_overlay}
 register_lazy "_mog-overlay.tcl" {toggle_mog_overlay toggle_mog_editor}
 register_lazy "_monitor.tcl" monitor_type
@@ -84,6 +85,7 @@ register_lazy "_vdp.tcl" {
 	v9990regs vpeek vpoke palette}
 register_lazy "_vdp_access_test.tcl" toggle_vdp_access_test
 register_lazy "_vdp_busy.tcl" toggle_vdp_busy
+register_lazy "_v9990_cmd_benchmark.tcl" v9990_cmd_benchmark
 register_lazy "_vdrive.tcl" vdrive
 register_lazy "_vgmrecorder.tcl" {vgm_rec vgm_rec_next vgm_rec_end}
 register_lazy "_vu-meters.tcl" toggle_vu_meters
@@ -0,0 +1,99 @@
+#include "BinaryReplayFile.hh"
+#include "File.hh"
+#include "MSXException.hh"
+#include "xxhash.hh"
+#include <zlib.h>
+#include <cassert>
+#include <cstring>
+
+namespace openmsx {
+namespace BinaryReplayFile {
+
+static const char MAGIC[] = "openMSX binary replay\n";
+static const size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+
+void writeHeader(File& file, string_view compatibility)
+{
+	assert(compatibility.size() < 256);
+	auto length = uint8_t(compatibility.size());
+	file.write(MAGIC, MAGIC_SIZE);
+	file.write(&length, sizeof(length));
+	file.write(compatibility.data(), length);
+}
+
+bool readHeader(File& file, std::string& compatibility)
+{
+	if (file.getSize() < MAGIC_SIZE) return false;
+	char magic[MAGIC_SIZE];
+	file.read(magic, MAGIC_SIZE);
+	if (memcmp(magic, MAGIC, MAGIC_SIZE) != 0) return false;
+
+	uint8_t length;
+	file.read(&length, sizeof(length));
+	compatibility.assign(length, '\0');
+	file.read(&compatibility[0], length);
+	return true;
+}
+
+void writeChunk(File& file, uint32_t type, const byte* data, size_t size)
+{
+	if (size > MAX_CHUNK_SIZE) {
+		throw MSXException("Replay data too large");
+	}
+	auto compressedSize = uLongf(compressBound(uLong(size)));
+	MemBuffer<byte> compressed(compressedSize);
+	// Compression speed matters more than size here, so use level 1.
+	if (compress2(compressed.data(), &compressedSize, data, uLong(size), 1)
+	    != Z_OK) {
+		throw MSXException("Error while compressing replay data");
+	}
+	uint32_t header[4] = {
+		type, uint32_t(size), uint32_t(compressedSize),
+		xxhash(string_view(reinterpret_cast<const char*>(compressed.data()),
+		                   compressedSize))
+	};
+	file.write(header, sizeof(header));
+	file.write(compressed.data(), compressedSize);
+}
+
+bool readChunk(File& file, uint32_t& type, MemBuffer<byte>& data, size_t& size)
+{
+	auto fileSize = file.getSize();
+	auto pos = file.getPos();
+	if (pos == fileSize) return false;
+	uint32_t header[4];
+	if ((fileSize - pos) < sizeof(header)) {
+		throw MSXException("Truncated replay file");
+	}
+	file.read(header, sizeof(header));
+	type = header[0];
+	size = header[1];
+	uint32_t compressedSize = header[2];
+	if ((size > MAX_CHUNK_SIZE) ||
+	    (compressedSize > compressBound(uLong(size)))) {
+		throw MSXException("Corrupt replay file");
+	}
+	if (compressedSize > (fileSize - file.getPos())) {
+		throw MSXException("Truncated replay file");
+	}
+	MemBuffer<byte> compressed(compressedSize);
+	file.read(compressed.data(), compressedSize);
+	if (xxhash(string_view(reinterpret_cast<const char*>(compressed.data()),
+	                       compressedSize)) != header[3]) {
+		throw MSXException("Corrupt replay file");
+	}
+	// The hash only catches accidental corruption. Zlib checks that the
+	// decompressed data fits in the buffer, and we check that it exactly
+	// fills it.
+	data.resize(size);
+	auto dstLen = uLongf(size);
+	if ((uncompress(data.data(), &dstLen, compressed.data(), compressedSize)
+	     != Z_OK) ||
+	    (dstLen != size)) {
+		throw MSXException("Corrupt replay file");
+	}
+	return true;
+}
+
+} // namespace BinaryReplayFile
+} // namespace openmsx
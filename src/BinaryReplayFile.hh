@@ -0,0 +1,62 @@
+#ifndef BINARYREPLAYFILE_HH
+#define BINARYREPLAYFILE_HH
+
+#include "MemBuffer.hh"
+#include "openmsx.hh"
+#include "string_view.hh"
+#include <string>
+#include <cstdint>
+
+namespace openmsx {
+
+class File;
+
+/** The file level of the binary replay format, see ReverseManager for what
+  * is stored in the chunks.
+  *   file:  magic, compatibility string (length byte + string), chunks
+  *   chunk: type, size, compressed size, hash (xxhash of the compressed
+  *          data), all 32-bit, followed by the zlib compressed data
+  * Replay files can come from anywhere, so the read functions don't trust
+  * any size in the file: malformed input results in an MSXException.
+  */
+namespace BinaryReplayFile {
+
+	/** Max (uncompressed) size of one chunk. */
+	const size_t MAX_CHUNK_SIZE = 256 * 1024 * 1024;
+
+	/**
+	 * Write the magic and the compatibility string.
+	 * @param file A newly created file.
+	 * @param compatibility At most 255 characters.
+	 */
+	void writeHeader(File& file, string_view compatibility);
+
+	/**
+	 * Read the start of a file.
+	 * @param file A newly opened file.
+	 * @param compatibility Gets the compatibility string (only when this
+	 *        is a binary replay).
+	 * @result False if the file doesn't start with the magic (e.g. for
+	 *         an XML replay).
+	 * @throw MSXException
+	 */
+	bool readHeader(File& file, std::string& compatibility);
+
+	/**
+	 * Compress and write one chunk.
+	 * @throw MSXException
+	 */
+	void writeChunk(File& file, uint32_t type, const byte* data, size_t size);
+
+	/**
+	 * Read and decompress the next chunk.
+	 * @result False at the end of the file.
+	 * @throw MSXException When the chunk is truncated or corrupt.
+	 */
+	bool readChunk(File& file, uint32_t& type, MemBuffer<byte>& data,
+	               size_t& size);
+
+} // namespace BinaryReplayFile
+} // namespace openmsx
+
+#endif
@@ -27,12 +27,16 @@ byte MSXDevice::unmappedWrite[0x10000];
 
 MSXDevice::MSXDevice(const DeviceConfig& config, const string& name)
 	: deviceConfig(config)
+	, memCacheInvalidations(0)
+	, memCacheLinesInvalidated(0)
 {
 	initName(name);
 }
 
 MSXDevice::MSXDevice(const DeviceConfig& config)
 	: deviceConfig(config)
+	, memCacheInvalidations(0)
+	, memCacheLinesInvalidated(0)
 {
 	initName(getDeviceConfig().getAttribute("id"));
 }
@@ -455,8 +459,20 @@ byte* MSXDevice::getWriteCacheLine(word /*start*/) const
 	return nullptr; // uncacheable
 }
 
+const byte* MSXDevice::getReadCachePage(word /*start*/) const
+{
+	return nullptr; // only per cache line
+}
+
+byte* MSXDevice::getWriteCachePage(word /*start*/) const
+{
+	return nullptr; // only per cache line
+}
+
 void MSXDevice::invalidateMemCache(word start, unsigned size)
 {
+	++memCacheInvalidations;
+	memCacheLinesInvalidated += (size + CacheLine::SIZE - 1) / CacheLine::SIZE;
 	getCPU().invalidateMemCache(start, size);
 }
 
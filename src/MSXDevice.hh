@@ -172,6 +172,24 @@ public:
 	 */
 	virtual byte* getWriteCacheLine(word start) const;
 
+	/**
+	 * Like getReadCacheLine(), but for the complete 16kB page
+	 * [start, start + CacheLine::PAGE_SIZE). Devices that map a page to
+	 * one contiguous buffer (plain RAM) can return that buffer, so the
+	 * CPU can cache all lines of the page in one go. The same
+	 * invalidation rules as for getReadCacheLine() apply.
+	 * The default implementation always returns a null pointer, then
+	 * the CPU falls back to getReadCacheLine().
+	 * The start of the interval is CacheLine::PAGE_SIZE aligned.
+	 */
+	virtual const byte* getReadCachePage(word start) const;
+
+	/**
+	 * Like getWriteCacheLine(), but for a complete 16kB page, see
+	 * getReadCachePage().
+	 */
+	virtual byte* getWriteCachePage(word start) const;
+
 	/**
 	 * Read a byte from a given memory location. Reading memory
 	 * via this method has no side effects (doesn't change the
@@ -208,6 +226,14 @@ public:
 	  */
 	void invalidateMemCache(word start, unsigned size);
 
+	/** Number of invalidateMemCache() calls made by this device and the
+	  * total number of CPU cache lines those calls invalidated. Only for
+	  * instrumentation (see 'machine_info memcache_invalidations'); both
+	  * counters wrap around.
+	  */
+	unsigned getMemCacheInvalidations() const { return memCacheInvalidations; }
+	unsigned getMemCacheLinesInvalidated() const { return memCacheLinesInvalidated; }
+
 	/** Get the mother board this device belongs to
 	  */
 	MSXMotherBoard& getMotherBoard() const;
@@ -300,6 +326,9 @@ private:
 
 	int ps;
 	int ss;
+
+	unsigned memCacheInvalidations;    // no need to serialize
+	unsigned memCacheLinesInvalidated; //
 };
 
 REGISTER_BASE_NAME_HELPER(MSXDevice, "Device");
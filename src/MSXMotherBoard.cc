@@ -18,6 +18,7 @@
 #include "PluggingController.hh"
 #include "MSXCPUInterface.hh"
 #include "MSXCPU.hh"
+#include "CacheLine.hh"
 #include "PanasonicMemory.hh"
 #include "MSXDeviceSwitch.hh"
 #include "MSXMapperIO.hh"
@@ -144,6 +145,18 @@ private:
 	MSXMotherBoard& motherBoard;
 };
 
+class MemCacheInfo final : public InfoTopic
+{
+public:
+	explicit MemCacheInfo(MSXMotherBoard& motherBoard);
+	void execute(span<const TclObject> tokens,
+	             TclObject& result) const override;
+	string help(const vector<string>& tokens) const override;
+	void tabCompletion(vector<string>& tokens) const override;
+private:
+	MSXMotherBoard& motherBoard;
+};
+
 class FastForwardHelper final : private Schedulable
 {
 public:
@@ -207,6 +220,7 @@ MSXMotherBoard::MSXMotherBoard(Reactor& reactor_)
 	machineNameInfo = make_unique<MachineNameInfo>(*this);
 	machineTypeInfo = make_unique<MachineTypeInfo>(*this);
 	deviceInfo = make_unique<DeviceInfo>(*this);
+	memCacheInfo = make_unique<MemCacheInfo>(*this);
 	debugger = make_unique<Debugger>(*this);
 
 	msxMixer->mute(); // powered down
@@ -994,6 +1008,81 @@ void DeviceInfo::tabCompletion(vector<string>& tokens) const
 }
 
 
+// MemCacheInfo
+
+MemCacheInfo::MemCacheInfo(MSXMotherBoard& motherBoard_)
+	: InfoTopic(motherBoard_.getMachineInfoCommand(), "memcache_invalidations")
+	, motherBoard(motherBoard_)
+{
+}
+
+static TclObject memCacheCounters(unsigned calls, unsigned lines)
+{
+	TclObject result;
+	result.addListElement(int(calls));
+	result.addListElement(int(lines));
+	return result;
+}
+
+void MemCacheInfo::execute(span<const TclObject> tokens, TclObject& result) const
+{
+	switch (tokens.size()) {
+	case 2: {
+		for (auto& d : motherBoard.availableDevices) {
+			if (d->getMemCacheInvalidations() == 0) continue;
+			result.addListElement(d->getName());
+			result.addListElement(memCacheCounters(
+				d->getMemCacheInvalidations(),
+				d->getMemCacheLinesInvalidated()));
+		}
+		auto& interface = motherBoard.getCPUInterface();
+		for (int page = 0; page < 4; ++page) {
+			unsigned calls = interface.getSlotSwitchInvalidations(page);
+			if (calls == 0) continue;
+			result.addListElement(strCat("slotselect page ", page));
+			result.addListElement(memCacheCounters(
+				calls, calls * (0x4000 / CacheLine::SIZE)));
+		}
+		break;
+	}
+	case 3: {
+		string_view deviceName = tokens[2].getString();
+		MSXDevice* device = motherBoard.findDevice(deviceName);
+		if (!device) {
+			throw CommandException("No such device: ", deviceName);
+		}
+		result = memCacheCounters(device->getMemCacheInvalidations(),
+		                          device->getMemCacheLinesInvalidated());
+		break;
+	}
+	default:
+		throw SyntaxError();
+	}
+}
+
+string MemCacheInfo::help(const vector<string>& /*tokens*/) const
+{
+	return "Shows how often the CPU memory cache was invalidated.\n"
+	       "Without arguments, returns a dict with for each device that "
+	       "invalidated the cache (and for each page where a slot switch "
+	       "did) the number of invalidations and the total number of "
+	       "invalidated cache lines. With a device name as argument, "
+	       "returns only these two counters for that device. The counters "
+	       "are cumulative and wrap around, sample them twice to get a "
+	       "rate (see memcache_invalidation_rate).";
+}
+
+void MemCacheInfo::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 3) {
+		auto names = to_vector(view::transform(
+			motherBoard.availableDevices,
+			[](auto& d) { return d->getName(); }));
+		completeString(tokens, names);
+	}
+}
+
+
 // FastForwardHelper
 
 FastForwardHelper::FastForwardHelper(MSXMotherBoard& motherBoard_)
@@ -35,6 +35,7 @@ class ListExtCmd;
 class LoadMachineCmd;
 class MachineNameInfo;
 class MachineTypeInfo;
+class MemCacheInfo;
 class MSXCliComm;
 class MSXCommandController;
 class MSXCPU;
@@ -261,6 +262,8 @@ private:
 	std::unique_ptr<MachineTypeInfo> machineTypeInfo;
 	std::unique_ptr<DeviceInfo>   deviceInfo;
 	friend class DeviceInfo;
+	std::unique_ptr<MemCacheInfo> memCacheInfo;
+	friend class MemCacheInfo;
 
 	std::unique_ptr<FastForwardHelper> fastForwardHelper;
 
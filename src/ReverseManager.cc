@@ -1,4 +1,6 @@
 #include "ReverseManager.hh"
+#include "BinaryReplayFile.hh"
+#include "ReverseSnapshotPruning.hh"
 #include "MSXMotherBoard.hh"
 #include "EventDistributor.hh"
 #include "StateChangeDistributor.hh"
@@ -9,6 +11,7 @@
 #include "MSXCommandController.hh"
 #include "XMLException.hh"
 #include "TclObject.hh"
+#include "File.hh"
 #include "FileOperations.hh"
 #include "FileContext.hh"
 #include "StateChange.hh"
@@ -18,15 +21,22 @@
 #include "Reactor.hh"
 #include "CommandException.hh"
 #include "MemBuffer.hh"
+#include "Version.hh"
+#include "build-info.hh"
 #include "ranges.hh"
 #include "serialize.hh"
 #include "serialize_stl.hh"
+#include "sha1.hh"
+#include "stl.hh"
+#include "strCat.hh"
 #include "view.hh"
 #include "xrange.hh"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <functional>
 #include <iomanip>
+#include <iterator>
 
 using std::string;
 using std::vector;
@@ -35,9 +45,21 @@ using std::move;
 
 namespace openmsx {
 
+using ReverseSnapshotPruning::MAX_SNAPSHOT_GAP;
+using ReverseSnapshotPruning::inMaxGapWindow;
+
 // Time between two snapshots (in seconds)
 static const double SNAPSHOT_PERIOD = 1.0;
 
+// Max time spent on creating extra snapshots after each regular snapshot
+// (in microseconds). This blocks the main thread, so keep it well below
+// the duration of one frame.
+static const uint64_t FILL_TIME_BUDGET = 2000;
+
+// Amount of emulated time per fastForward() step while filling a gap (in
+// seconds), small enough to (mostly) stay within FILL_TIME_BUDGET.
+static const EmuDuration FILL_STEP = EmuDuration(0.01);
+
 // Max number of snapshots in a replay file
 static const unsigned MAX_NOF_SNAPSHOTS = 10;
 
@@ -59,7 +81,8 @@ static const char* const REPLAY_DIR = "replays";
 struct Replay
 {
 	explicit Replay(Reactor& reactor_)
-		: reactor(reactor_), currentTime(EmuTime::dummy()) {}
+		: reactor(reactor_), currentTime(EmuTime::dummy())
+		, reRecordCount(0) {}
 
 	Reactor& reactor;
 
@@ -146,6 +169,9 @@ ReverseManager::ReverseManager(MSXMotherBoard& motherBoard_)
 	, replayIndex(0)
 	, collecting(false)
 	, pendingTakeSnapshot(false)
+	, fillEventCount(0)
+	, fillEndSeqNum(0)
+	, fillEndTime(EmuTime::zero)
 	, reRecordCount(0)
 {
 	eventDistributor.registerEventListener(OPENMSX_TAKE_REVERSE_SNAPSHOT, *this);
@@ -189,6 +215,7 @@ void ReverseManager::stop()
 		replayIndex = 0;
 		collecting = false;
 		pendingTakeSnapshot = false;
+		fillBoard.reset();
 	}
 	assert(!pendingTakeSnapshot);
 	assert(!isCollecting());
@@ -556,52 +583,30 @@ void ReverseManager::saveReplay(
 
 	string filename;
 	int maxNofExtraSnapshots = MAX_NOF_SNAPSHOTS;
-	switch (tokens.size()) {
-	case 2:
-		// nothing
-		break;
-	case 3:
-		filename = tokens[2].getString().str();
-		break;
-	case 4:
-	case 5:
-		size_t tn;
-		for (tn = 2; tn < (tokens.size() - 1); ++tn) {
-			if (tokens[tn] == "-maxnofextrasnapshots") {
-				maxNofExtraSnapshots = tokens[tn + 1].getInt(interp);
-				break;
+	bool binary = false;
+	for (size_t i = 2; i < tokens.size(); ++i) {
+		if (tokens[i] == "-maxnofextrasnapshots") {
+			if (++i == tokens.size()) {
+				throw CommandException("Missing argument");
 			}
+			maxNofExtraSnapshots = tokens[i].getInt(interp);
+		} else if (tokens[i] == "-binary") {
+			binary = true;
+		} else if (filename.empty()) {
+			filename = tokens[i].getString().str();
+		} else {
+			throw SyntaxError();
 		}
-		if (tn == (tokens.size() - 1)) throw SyntaxError();
-		if (tokens.size() == 5) {
-			filename = tokens[tn == 2 ? 4 : 2].getString().str();
-		}
-		if (maxNofExtraSnapshots < 0) {
-			throw CommandException("Maximum number of snapshots should be at least 0");
-		}
-
-		break;
-	default:
-		throw SyntaxError();
+	}
+	if (maxNofExtraSnapshots < 0) {
+		throw CommandException("Maximum number of snapshots should be at least 0");
 	}
 	filename = FileOperations::parseCommandFileArgument(
 		filename, REPLAY_DIR, "openmsx", ".omr");
 
-	auto& reactor = motherBoard.getReactor();
-	Replay replay(reactor);
-	replay.reRecordCount = reRecordCount;
-
-	// store current time (possibly somewhere in the middle of the timeline)
-	// so that on load we can go back there
-	replay.currentTime = getCurrentTime();
-
-	// restore first snapshot to be able to serialize it to a file
-	auto initialBoard = reactor.createEmptyMotherBoard();
-	MemInputArchive in(begin(chunks)->second.savestate.data(),
-	                   begin(chunks)->second.size,
-			   begin(chunks)->second.deltaBlocks);
-	in.serialize("machine", *initialBoard);
-	replay.motherBoards.push_back(move(initialBoard));
+	// the first snapshot is always included
+	vector<Chunks::const_iterator> snapshots;
+	snapshots.push_back(begin(chunks));
 
 	if (maxNofExtraSnapshots > 0) {
 		// determine which extra snapshots to put in the replay
@@ -625,12 +630,7 @@ void ReverseManager::saveReplay(
 				assert(it->second.time <= nextPartitionEnd);
 				if (it != lastAddedIt) {
 					// this is a new one, add it to the list of snapshots
-					Reactor::Board board = reactor.createEmptyMotherBoard();
-					MemInputArchive in2(it->second.savestate.data(),
-							    it->second.size,
-							    it->second.deltaBlocks);
-					in2.serialize("machine", *board);
-					replay.motherBoards.push_back(move(board));
+					snapshots.push_back(it);
 					lastAddedIt = it;
 				}
 				++it;
@@ -651,9 +651,11 @@ void ReverseManager::saveReplay(
 			getCurrentTime()));
 	}
 	try {
-		XmlOutputArchive out(filename);
-		replay.events = &history.events;
-		out.serialize("replay", replay);
+		if (binary) {
+			saveBinaryReplay(filename, snapshots);
+		} else {
+			saveXmlReplay(filename, snapshots);
+		}
 	} catch (MSXException&) {
 		if (addSentinel) {
 			history.events.pop_back();
@@ -672,51 +674,168 @@ void ReverseManager::saveReplay(
 	result.setString("Saved replay to " + filename);
 }
 
-void ReverseManager::loadReplay(
-	Interpreter& interp, span<const TclObject> tokens, TclObject& result)
+void ReverseManager::saveXmlReplay(
+	const string& filename, const vector<Chunks::const_iterator>& snapshots)
 {
-	if (tokens.size() < 3) throw SyntaxError();
+	auto& reactor = motherBoard.getReactor();
+	Replay replay(reactor);
+	replay.reRecordCount = reRecordCount;
 
-	vector<string> arguments;
-	const TclObject* whereArg = nullptr;
-	bool enableViewOnly = false;
+	// store current time (possibly somewhere in the middle of the timeline)
+	// so that on load we can go back there
+	replay.currentTime = getCurrentTime();
 
-	for (size_t i = 2; i < tokens.size(); ++i) {
-		string_view token = tokens[i].getString();
-		if (token == "-viewonly") {
-			enableViewOnly = true;
-		} else if (token == "-goto") {
-			if (++i == tokens.size()) {
-				throw CommandException("Missing argument");
-			}
-			whereArg = &tokens[i];
-		} else {
-			arguments.push_back(token.str());
+	// restore the snapshots to be able to serialize them to a file
+	for (auto& it : snapshots) {
+		const auto& chunk = it->second;
+		Reactor::Board board = reactor.createEmptyMotherBoard();
+		MemInputArchive in(chunk.savestate.data(), chunk.size,
+		                   chunk.deltaBlocks);
+		in.serialize("machine", *board);
+		replay.motherBoards.push_back(move(board));
+	}
+
+	XmlOutputArchive out(filename);
+	replay.events = &history.events;
+	out.serialize("replay", replay);
+}
+
+// The binary replay format is a sequence of chunks (see BinaryReplayFile),
+// each containing a MemOutputArchive (without delta blocks), so it can be
+// loaded one chunk at a time. Because memory archives don't store class
+// versions, such a replay can only be loaded by the same openMSX version on
+// the same platform. The XML format remains the default (and the one to use
+// to exchange replays).
+// The first chunk is a snapshot, each snapshot is followed by the events
+// up to the next snapshot (possibly split over several chunks). The
+// last chunk stores the current time and the rerecord count.
+enum BinaryReplayChunk : uint32_t { SNAPSHOT_CHUNK = 1, EVENTS_CHUNK, END_CHUNK };
+static const size_t EVENTS_PER_CHUNK = 4096;
+
+static string getBinaryReplayCompatibility()
+{
+	return strCat(Version::full(), ' ', TARGET_PLATFORM, ' ',
+	              8 * sizeof(void*), "-bit ",
+	              OPENMSX_BIGENDIAN ? "big" : "little", "-endian");
+}
+
+static void writeBinaryReplayChunk(File& file, uint32_t type,
+                                   MemOutputArchive& out)
+{
+	size_t size;
+	auto buf = out.releaseBuffer(size);
+	BinaryReplayFile::writeChunk(file, type, buf.data(), size);
+}
+
+void ReverseManager::saveBinaryReplay(
+	const string& filename, const vector<Chunks::const_iterator>& snapshots)
+{
+	auto& reactor = motherBoard.getReactor();
+	File file(filename, File::TRUNCATE);
+	BinaryReplayFile::writeHeader(file, getBinaryReplayCompatibility());
+
+	const auto& events = history.events;
+	auto event = begin(events);
+	for (auto it = begin(snapshots); it != end(snapshots); ++it) {
+		// Only one machine is restored at a time.
+		const auto& chunk = (*it)->second;
+		{
+			Reactor::Board board = reactor.createEmptyMotherBoard();
+			MemInputArchive in(chunk.savestate.data(), chunk.size,
+			                   chunk.deltaBlocks);
+			in.serialize("machine", *board);
+			MemOutputArchive out;
+			out.serialize("machine", *board);
+			writeBinaryReplayChunk(file, SNAPSHOT_CHUNK, out);
+		}
+
+		auto last = end(events);
+		if (std::next(it) != end(snapshots)) {
+			const auto& nextTime = (*std::next(it))->second.time;
+			last = std::find_if(event, end(events), [&](auto& e) {
+				return e->getTime() >= nextTime;
+			});
+		}
+		while (event != last) {
+			auto num = std::min<size_t>(last - event, EVENTS_PER_CHUNK);
+			Events batch(event, event + num);
+			MemOutputArchive out;
+			out.serialize("events", batch);
+			writeBinaryReplayChunk(file, EVENTS_CHUNK, out);
+			event += num;
 		}
 	}
 
-	if (arguments.size() != 1) throw SyntaxError();
+	MemOutputArchive out;
+	out.serialize("currentTime", getCurrentTime());
+	out.serialize("reRecordCount", reRecordCount);
+	writeBinaryReplayChunk(file, END_CHUNK, out);
+}
 
-	// resolve the filename
+static string resolveReplayFile(const string& fileNameArg)
+{
 	auto context = userDataFileContext(REPLAY_DIR);
-	string fileNameArg = arguments[0];
-	string filename;
 	try {
 		// Try filename as typed by user.
-		filename = context.resolve(fileNameArg);
+		return context.resolve(fileNameArg);
 	} catch (MSXException& /*e1*/) { try {
 		// Not found, try adding '.omr'.
-		filename = context.resolve(fileNameArg + ".omr");
+		return context.resolve(fileNameArg + ".omr");
 	} catch (MSXException& e2) { try {
 		// Again not found, try adding '.gz'.
 		// (this is for backwards compatibility).
-		filename = context.resolve(fileNameArg + ".gz");
+		return context.resolve(fileNameArg + ".gz");
 	} catch (MSXException& /*e3*/) {
 		// Show error message that includes the default extension.
 		throw e2;
 	}}}
+}
+
+// Add a snapshot of the given machine to a history that's being loaded. The
+// events before the snapshot must already be present.
+void ReverseManager::addReplaySnapshot(ReverseHistory& newHistory,
+                                       MSXMotherBoard& board)
+{
+	ReverseChunk newChunk;
+	newChunk.time = board.getCurrentTime();
+
+	MemOutputArchive out(newHistory.lastDeltaBlocks,
+	                     newChunk.deltaBlocks, false);
+	out.serialize("machine", board);
+	newChunk.savestate = out.releaseBuffer(newChunk.size);
+
+	const auto& events = newHistory.events;
+	newChunk.eventCount = unsigned(std::find_if(begin(events), end(events),
+		[&](auto& e) { return !(e->getTime() < newChunk.time); }) -
+		begin(events));
+
+	newHistory.chunks[newHistory.getNextSeqNum(newChunk.time)] =
+		move(newChunk);
+}
+
+// Load the snapshots and events of a replay file (in either format).
+void ReverseManager::loadReplayFile(
+	const string& filename, ReverseHistory& newHistory,
+	EmuTime& savedTime, unsigned& savedReRecordCount)
+{
+	try {
+		File file(filename, "rb");
+		string compatibility;
+		if (BinaryReplayFile::readHeader(file, compatibility)) {
+			if (compatibility != getBinaryReplayCompatibility()) {
+				throw MSXException(
+					"binary replay was saved by a different "
+					"openMSX version or platform (",
+					compatibility, ")");
+			}
+			loadBinaryReplay(file, newHistory, savedTime,
+			                 savedReRecordCount);
+			return;
+		}
+	} catch (MSXException& e) {
+		throw CommandException("Cannot load replay: ", e.getMessage());
+	}
 
-	// restore replay
 	auto& reactor = motherBoard.getReactor();
 	Replay replay(reactor);
 	Events events;
@@ -731,6 +850,97 @@ void ReverseManager::loadReplay(
 		throw CommandException("Cannot load replay: ", e.getMessage());
 	}
 
+	assert(!replay.motherBoards.empty());
+	auto& firstReverseManager = replay.motherBoards[0]->getReverseManager();
+	if (firstReverseManager.reRecordCount == 0) {
+		// serialize Replay version >= 4
+		savedReRecordCount = replay.reRecordCount;
+	} else {
+		// firstReverseManager.reRecordCount is initialized via
+		// call from MSXMotherBoard to setReRecordCount()
+		savedReRecordCount = firstReverseManager.reRecordCount;
+	}
+	savedTime = replay.currentTime;
+
+	// Restore event log
+	swap(newHistory.events, events);
+
+	// Restore snapshots
+	for (auto& m : replay.motherBoards) {
+		addReplaySnapshot(newHistory, *m);
+	}
+}
+
+void ReverseManager::loadBinaryReplay(
+	File& file, ReverseHistory& newHistory,
+	EmuTime& savedTime, unsigned& savedReRecordCount)
+{
+	auto& reactor = motherBoard.getReactor();
+	uint32_t type;
+	MemBuffer<byte> data;
+	size_t size;
+	bool foundEnd = false;
+	while (!foundEnd && BinaryReplayFile::readChunk(file, type, data, size)) {
+		MemInputArchive in(data.data(), size);
+		switch (type) {
+		case SNAPSHOT_CHUNK: {
+			Reactor::Board board = reactor.createEmptyMotherBoard();
+			in.serialize("machine", *board);
+			addReplaySnapshot(newHistory, *board);
+			break;
+		}
+		case EVENTS_CHUNK: {
+			Events batch;
+			in.serialize("events", batch);
+			append(newHistory.events, std::move(batch));
+			break;
+		}
+		case END_CHUNK:
+			in.serialize("currentTime", savedTime);
+			in.serialize("reRecordCount", savedReRecordCount);
+			foundEnd = true;
+			break;
+		default:
+			throw MSXException("Corrupt replay file");
+		}
+	}
+	if (!foundEnd || newHistory.chunks.empty()) {
+		throw MSXException("Incomplete replay file");
+	}
+}
+
+void ReverseManager::loadReplay(
+	Interpreter& interp, span<const TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 3) throw SyntaxError();
+
+	vector<string> arguments;
+	const TclObject* whereArg = nullptr;
+	bool enableViewOnly = false;
+
+	for (size_t i = 2; i < tokens.size(); ++i) {
+		string_view token = tokens[i].getString();
+		if (token == "-viewonly") {
+			enableViewOnly = true;
+		} else if (token == "-goto") {
+			if (++i == tokens.size()) {
+				throw CommandException("Missing argument");
+			}
+			whereArg = &tokens[i];
+		} else {
+			arguments.push_back(token.str());
+		}
+	}
+
+	if (arguments.size() != 1) throw SyntaxError();
+
+	// restore replay
+	string filename = resolveReplayFile(arguments[0]);
+	ReverseHistory newHistory;
+	auto savedTime = EmuTime::zero;
+	unsigned newReRecordCount = 0;
+	loadReplayFile(filename, newHistory, savedTime, newReRecordCount);
+
 	// get destination time index
 	auto destination = EmuTime::zero;
 	string_view where = whereArg ? whereArg->getString() : "begin";
@@ -739,7 +949,7 @@ void ReverseManager::loadReplay(
 	} else if (where == "end") {
 		destination = EmuTime::infinity;
 	} else if (where == "savetime") {
-		destination = replay.currentTime;
+		destination = savedTime;
 	} else {
 		destination += EmuDuration(whereArg->getDouble(interp));
 	}
@@ -749,54 +959,73 @@ void ReverseManager::loadReplay(
 	// now we can change the view only mode
 	motherBoard.getStateChangeDistributor().setViewOnlyMode(enableViewOnly);
 
-	assert(!replay.motherBoards.empty());
-	auto& newReverseManager = replay.motherBoards[0]->getReverseManager();
-	auto& newHistory = newReverseManager.history;
-
-	if (newReverseManager.reRecordCount == 0) {
-		// serialize Replay version >= 4
-		newReverseManager.reRecordCount = replay.reRecordCount;
-	} else {
-		// newReverseManager.reRecordCount is initialized via
-		// call from MSXMotherBoard to setReRecordCount()
-	}
-
-	// Restore event log
-	swap(newHistory.events, events);
-	auto& newEvents = newHistory.events;
-
-	// Restore snapshots
-	unsigned replayIdx = 0;
-	for (auto& m : replay.motherBoards) {
-		ReverseChunk newChunk;
-		newChunk.time = m->getCurrentTime();
-
-		MemOutputArchive out(newHistory.lastDeltaBlocks,
-		                     newChunk.deltaBlocks, false);
-		out.serialize("machine", *m);
-		newChunk.savestate = out.releaseBuffer(newChunk.size);
-
-		// update replayIdx
-		// TODO: should we use <= instead??
-		while (replayIdx < newEvents.size() &&
-		       (newEvents[replayIdx]->getTime() < newChunk.time)) {
-			replayIdx++;
-		}
-		newChunk.eventCount = replayIdx;
-
-		newHistory.chunks[newHistory.getNextSeqNum(newChunk.time)] =
-			move(newChunk);
-	}
-
 	// Note: untill this point we didn't make any changes to the current
 	// ReverseManager/MSXMotherBoard yet
-	reRecordCount = newReverseManager.reRecordCount;
+	reRecordCount = newReRecordCount;
 	bool novideo = false;
 	goTo(destination, novideo, newHistory, false); // move to different time-line
 
 	result.setString("Loaded replay from " + filename);
 }
 
+void ReverseManager::verifyReplay(span<const TclObject> tokens,
+                                  TclObject& result)
+{
+	if (tokens.size() < 3) throw SyntaxError();
+
+	// Each replay is loaded in its own (not active) machine and emulated
+	// from its first snapshot till its end time, as fast as possible. The
+	// current machine is not changed. Errors are reported per replay, so
+	// that one bad file doesn't stop the verification of the others.
+	auto& reactor = motherBoard.getReactor();
+	for (auto& token : view::drop(tokens, 2)) {
+		TclObject line;
+		line.addListElement("file");
+		line.addListElement(token);
+		try {
+			string filename = resolveReplayFile(token.getString().str());
+			ReverseHistory hist;
+			auto savedTime = EmuTime::zero;
+			unsigned savedReRecordCount = 0;
+			loadReplayFile(filename, hist, savedTime, savedReRecordCount);
+
+			auto& events = hist.events;
+			if (events.empty() ||
+			    !dynamic_cast<const EndLogEvent*>(events.back().get())) {
+				events.push_back(std::make_shared<EndLogEvent>(
+					savedTime));
+			}
+			const auto& chunk = begin(hist.chunks)->second;
+			if (events.back()->getTime() < chunk.time) {
+				throw CommandException(
+					"Replay ends before its first snapshot");
+			}
+			EmuTime endTime = events.back()->getTime();
+			unsigned eventCount = chunk.eventCount;
+
+			// Only the first snapshot is used, the others would
+			// skip (part of) the emulation we want to verify.
+			Reactor::Board board = reactor.createEmptyMotherBoard();
+			MemInputArchive in(chunk.savestate.data(), chunk.size,
+			                   chunk.deltaBlocks);
+			in.serialize("machine", *board);
+			auto& manager = board->getReverseManager();
+			manager.transferHistory(hist, eventCount);
+			manager.syncNewSnapshot.removeSyncPoint();
+			board->fastForward(endTime, true);
+
+			line.addListElement("time");
+			line.addListElement((board->getCurrentTime() - EmuTime::zero).toDouble());
+			line.addListElement("hash");
+			line.addListElement(board->getDebugger().getDebuggablesHash().toString());
+		} catch (MSXException& e) {
+			line.addListElement("error");
+			line.addListElement(e.getMessage());
+		}
+		result.addListElement(line);
+	}
+}
+
 void ReverseManager::transferHistory(ReverseHistory& oldHistory,
                                      unsigned oldEventCount)
 {
@@ -884,6 +1113,7 @@ int ReverseManager::signalEvent(const shared_ptr<const Event>& event)
 		takeSnapshot(getCurrentTime());
 		// schedule creation of next snapshot
 		schedule(getCurrentTime());
+		fillGaps();
 	}
 	return 0;
 }
@@ -904,7 +1134,8 @@ void ReverseManager::takeSnapshot(EmuTime::param time)
 	// TODO does snapshot pruning still happen correctly (often enough)
 	//      when going back/forward in time?
 	unsigned seqNum = history.getNextSeqNum(time);
-	dropOldSnapshots<25>(seqNum);
+	ReverseSnapshotPruning::dropOldSnapshots<25>(history.chunks, seqNum);
+	ReverseSnapshotPruning::dropOutOfWindow<25>(history.chunks, seqNum);
 
 	// During replay we might already have a snapshot with the current
 	// sequence number, though this snapshot does not necessarily have the
@@ -972,33 +1203,102 @@ void ReverseManager::stopReplay(EmuTime::param time)
 	assert(!isReplaying());
 }
 
-/* Should be called each time a new snapshot is added.
- * This function will erase zero or more earlier snapshots so that there are
- * more snapshots of recent history and less of distant history. It has the
- * following properties:
- *  - the very oldest snapshot is never deleted
- *  - it keeps the N or N+1 most recent snapshots (snapshot distance = 1)
- *  - then it keeps N or N+1 with snapshot distance 2
- *  - then N or N+1 with snapshot distance 4
- *  - ... and so on
- * @param count The index of the just added (or about to be added) element.
- *              First element should have index 1.
- */
-template<unsigned N>
-void ReverseManager::dropOldSnapshots(unsigned count)
+void ReverseManager::fillGaps()
 {
-	unsigned y = (count + N) ^ (count + N + 1);
-	unsigned d = N;
-	unsigned d2 = 2 * N + 1;
-	while (true) {
-		y >>= 1;
-		if ((y == 0) || (count < d)) return;
-		history.chunks.erase(count - d);
-		d += d2;
-		d2 *= 2;
+	// Note: this runs on the main thread (in between two emulated
+	// frames), the emulation of different machines cannot run in parallel
+	// (e.g. they share the Tcl interpreter and the settings).
+	auto deadline = Timer::getTime() + FILL_TIME_BUDGET;
+	while (Timer::getTime() < deadline) {
+		if (fillBoard) {
+			// Is the history we're re-emulating still the same?
+			// E.g. 'reverse truncatereplay' or replaying a
+			// snapshot with the same sequence number changes it.
+			auto it = history.chunks.find(fillEndSeqNum);
+			if ((it == end(history.chunks)) ||
+			    (it->second.time != fillEndTime)) {
+				fillBoard.reset();
+			}
+		}
+		if (!fillBoard && !startFill()) return; // no (more) gaps
+
+		auto fillTime = fillBoard->getCurrentTime();
+		if ((fillEndTime - fillTime) <= MAX_SNAPSHOT_GAP) {
+			// this gap is done
+			fillBoard.reset();
+			continue;
+		}
+		// Put the extra snapshots at half the max distance, because
+		// fastForward() can run a bit past the requested time.
+		auto target = std::min(fillTime + MAX_SNAPSHOT_GAP / 2,
+		                       fillEndTime);
+		while ((fillBoard->getCurrentTime() < target) &&
+		       (Timer::getTime() < deadline)) {
+			fillBoard->fastForward(std::min(target,
+				fillBoard->getCurrentTime() + FILL_STEP), true);
+		}
+		if (fillBoard->getCurrentTime() >= target) {
+			takeFillSnapshot();
+		}
 	}
 }
 
+// Search the first two snapshots (that end in the MAX_GAP_WINDOW) that are
+// too far apart, and restore the first one (and the events in between) in
+// the fill machine.
+bool ReverseManager::startFill()
+{
+	assert(!fillBoard);
+	auto& chunks = history.chunks;
+	if (chunks.empty()) return false;
+	auto it = std::adjacent_find(begin(chunks), end(chunks),
+		[&](auto& p1, auto& p2) {
+			return inMaxGapWindow(chunks, p2.second.time) &&
+			       ((p2.second.time - p1.second.time) > MAX_SNAPSHOT_GAP);
+		});
+	if (it == end(chunks)) return false;
+	auto& chunk = it->second;
+	auto& endChunk = std::next(it)->second;
+
+	fillBoard = motherBoard.getReactor().createEmptyMotherBoard();
+	MemInputArchive in(chunk.savestate.data(), chunk.size, chunk.deltaBlocks);
+	in.serialize("machine", *fillBoard);
+
+	// Replay (a copy of) the events up to the end of the gap.
+	ReverseHistory fillHistory;
+	auto& events = history.events;
+	auto first = begin(events) + chunk.eventCount;
+	auto last = std::find_if(first, end(events), [&](auto& e) {
+		return e->getTime() >= endChunk.time;
+	});
+	fillHistory.events.assign(first, last);
+	fillHistory.events.push_back(std::make_shared<EndLogEvent>(endChunk.time));
+	auto& fillManager = fillBoard->getReverseManager();
+	fillManager.transferHistory(fillHistory, 0);
+	fillManager.syncNewSnapshot.removeSyncPoint();
+
+	fillDeltaBlocks.clear();
+	fillEventCount = chunk.eventCount;
+	fillEndSeqNum = std::next(it)->first;
+	fillEndTime = endChunk.time;
+	return true;
+}
+
+void ReverseManager::takeFillSnapshot()
+{
+	auto time = fillBoard->getCurrentTime();
+	unsigned seqNum = history.getNextSeqNum(time);
+	if (history.chunks.count(seqNum)) return; // don't replace existing ones
+
+	ReverseChunk& newChunk = history.chunks[seqNum];
+	MemOutputArchive out(fillDeltaBlocks, newChunk.deltaBlocks, true);
+	out.serialize("machine", *fillBoard);
+	newChunk.time = time;
+	newChunk.savestate = out.releaseBuffer(newChunk.size);
+	newChunk.eventCount = fillEventCount +
+		fillBoard->getReverseManager().replayIndex;
+}
+
 void ReverseManager::schedule(EmuTime::param time)
 {
 	syncNewSnapshot.setSyncPoint(time + EmuDuration(SNAPSHOT_PERIOD));
@@ -1036,6 +1336,8 @@ void ReverseManager::ReverseCmd::execute(span<const TclObject> tokens, TclObject
 		return manager.saveReplay(interp, tokens, result);
 	} else if (subcommand == "loadreplay") {
 		return manager.loadReplay(interp, tokens, result);
+	} else if (subcommand == "verifyreplay") {
+		manager.verifyReplay(tokens, result);
 	} else if (subcommand == "viewonlymode") {
 		auto& distributor = manager.motherBoard.getStateChangeDistributor();
 		switch (tokens.size()) {
@@ -1066,8 +1368,9 @@ string ReverseManager::ReverseCmd::help(const vector<string>& /*tokens*/) const
 	       "goto <time>         go to an absolute moment in time\n"
 	       "viewonlymode <bool> switch viewonly mode on or off\n"
 	       "truncatereplay      stop replaying and remove all 'future' data\n"
-	       "savereplay [<name>] save the first snapshot and all replay data as a 'replay' (with optional name)\n"
-	       "loadreplay [-goto <begin|end|savetime|<n>>] [-viewonly] <name>   load a replay (snapshot and replay data) with given name and start replaying\n";
+	       "savereplay [-binary] [<name>]   save the first snapshot and all replay data as a 'replay' (with optional name), optionally in the (faster, but version specific) binary format\n"
+	       "loadreplay [-goto <begin|end|savetime|<n>>] [-viewonly] <name>   load a replay (snapshot and replay data) with given name and start replaying\n"
+	       "verifyreplay <name> [<name> ...]   emulate the given replays from begin to end, one after another (this blocks until all are done), and report the end time and a hash of the final state\n";
 }
 
 void ReverseManager::ReverseCmd::tabCompletion(vector<string>& tokens) const
@@ -1076,14 +1379,18 @@ void ReverseManager::ReverseCmd::tabCompletion(vector<string>& tokens) const
 		static const char* const subCommands[] = {
 			"start", "stop", "status", "goback", "goto",
 			"savereplay", "loadreplay", "viewonlymode",
-			"truncatereplay",
+			"truncatereplay", "verifyreplay",
 		};
 		completeString(tokens, subCommands);
-	} else if ((tokens.size() == 3) || (tokens[1] == "loadreplay")) {
-		if (tokens[1] == "loadreplay" || tokens[1] == "savereplay") {
+	} else if ((tokens.size() == 3) || (tokens[1] == "loadreplay") ||
+	           (tokens[1] == "verifyreplay")) {
+		if (tokens[1] == "loadreplay" || tokens[1] == "savereplay" ||
+		    tokens[1] == "verifyreplay") {
 			std::vector<const char*> cmds;
 			if (tokens[1] == "loadreplay") {
 				cmds = { "-goto", "-viewonly" };
+			} else if (tokens[1] == "savereplay") {
+				cmds = { "-binary" };
 			}
 			completeFileName(tokens, userDataFileContext(REPLAY_DIR), cmds);
 		} else if (tokens[1] == "viewonlymode") {
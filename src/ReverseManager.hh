@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <cstdint>
+#include <string>
 
 namespace openmsx {
 
@@ -23,6 +24,7 @@ class EventDelay;
 class EventDistributor;
 class TclObject;
 class Interpreter;
+class File;
 
 class ReverseManager final : private EventListener, private StateChangeRecorder
 {
@@ -89,6 +91,17 @@ private:
 	                span<const TclObject> tokens, TclObject& result);
 	void loadReplay(Interpreter& interp,
 	                span<const TclObject> tokens, TclObject& result);
+	void verifyReplay(span<const TclObject> tokens, TclObject& result);
+	void saveXmlReplay(const std::string& filename,
+	                   const std::vector<Chunks::const_iterator>& snapshots);
+	void saveBinaryReplay(const std::string& filename,
+	                      const std::vector<Chunks::const_iterator>& snapshots);
+	void loadReplayFile(const std::string& filename, ReverseHistory& newHistory,
+	                    EmuTime& savedTime, unsigned& savedReRecordCount);
+	void loadBinaryReplay(File& file, ReverseHistory& newHistory,
+	                      EmuTime& savedTime, unsigned& savedReRecordCount);
+	static void addReplaySnapshot(ReverseHistory& newHistory,
+	                              MSXMotherBoard& board);
 
 	void signalStopReplay(EmuTime::param time);
 	EmuTime::param getEndTime(const ReverseHistory& history) const;
@@ -101,7 +114,9 @@ private:
 	void takeSnapshot(EmuTime::param time);
 	void schedule(EmuTime::param time);
 	void replayNextEvent();
-	template<unsigned N> void dropOldSnapshots(unsigned count);
+	void fillGaps();
+	bool startFill();
+	void takeFillSnapshot();
 
 	// Schedulable
 	struct SyncNewSnapshot : Schedulable {
@@ -150,6 +165,16 @@ private:
 	bool collecting;
 	bool pendingTakeSnapshot;
 
+	// Snapshots that are too far apart (e.g. the snapshots from a loaded
+	// replay) are filled up with extra snapshots by re-emulating the
+	// history in between on a separate machine. This is done in small
+	// steps after each regular snapshot, see fillGaps().
+	std::unique_ptr<MSXMotherBoard> fillBoard;
+	LastDeltaBlocks fillDeltaBlocks;
+	unsigned fillEventCount; // event index at the start of fillBoard
+	unsigned fillEndSeqNum;  // the snapshot at the end of the gap
+	EmuTime fillEndTime;
+
 	unsigned reRecordCount;
 
 	friend struct Replay;
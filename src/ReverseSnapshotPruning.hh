@@ -0,0 +1,129 @@
+#ifndef REVERSESNAPSHOTPRUNING_HH
+#define REVERSESNAPSHOTPRUNING_HH
+
+#include "EmuDuration.hh"
+#include "EmuTime.hh"
+#include <cassert>
+#include <iterator>
+
+namespace openmsx {
+
+/** Decides which of the reverse snapshots to keep. The functions work on a
+  * std::map from sequence number (roughly the number of seconds since the
+  * first snapshot) to a struct that has a 'time' member, so they can be
+  * tested without a running machine.
+  */
+namespace ReverseSnapshotPruning {
+
+	// Max distance between two snapshots (in seconds). Going to an
+	// arbitrary moment in the recent history never has to re-emulate more
+	// than this.
+	static const EmuDuration MAX_SNAPSHOT_GAP = EmuDuration(10.0);
+
+	// The MAX_SNAPSHOT_GAP rule only applies to the snapshots in this
+	// window before the most recent snapshot (in seconds). Going to a
+	// moment before this window may re-emulate more.
+	static const EmuDuration MAX_GAP_WINDOW = EmuDuration(600.0);
+
+	/** Is the given time recent enough for the MAX_SNAPSHOT_GAP rule? */
+	template<typename Chunks>
+	bool inMaxGapWindow(const Chunks& chunks, EmuTime::param time)
+	{
+		assert(!chunks.empty());
+		auto newest = std::prev(end(chunks))->second.time;
+		return (time >= newest) || ((newest - time) <= MAX_GAP_WINDOW);
+	}
+
+	/** Would removing this snapshot leave a gap that's too large? */
+	template<typename Chunks>
+	bool isNeededForMaxGap(const Chunks& chunks,
+	                       typename Chunks::const_iterator it)
+	{
+		if (it == begin(chunks)) return true;
+		auto next = std::next(it);
+		if (next == end(chunks)) return true;
+		if (!inMaxGapWindow(chunks, it->second.time)) return false;
+		return (next->second.time - std::prev(it)->second.time) >
+		       MAX_SNAPSHOT_GAP;
+	}
+
+	/* Should be called each time a new snapshot is added.
+	 * This function will erase zero or more earlier snapshots so that
+	 * there are more snapshots of recent history and less of distant
+	 * history. It has the following properties:
+	 *  - the very oldest snapshot is never deleted
+	 *  - it keeps the N or N+1 most recent snapshots (snapshot distance = 1)
+	 *  - then it keeps N or N+1 with snapshot distance 2
+	 *  - then N or N+1 with snapshot distance 4
+	 *  - ... and so on
+	 * Snapshots that are still needed for the MAX_SNAPSHOT_GAP rule are
+	 * skipped here, dropOutOfWindow() erases them later.
+	 * @param count The index of the just added (or about to be added)
+	 *              element. First element should have index 1.
+	 */
+	template<unsigned N, typename Chunks>
+	void dropOldSnapshots(Chunks& chunks, unsigned count)
+	{
+		unsigned y = (count + N) ^ (count + N + 1);
+		unsigned d = N;
+		unsigned d2 = 2 * N + 1;
+		while (true) {
+			y >>= 1;
+			if ((y == 0) || (count < d)) return;
+			auto it = chunks.find(count - d);
+			if ((it != end(chunks)) && !isNeededForMaxGap(chunks, it)) {
+				chunks.erase(it);
+			}
+			d += d2;
+			d2 *= 2;
+		}
+	}
+
+	/** Would dropOldSnapshots<N>() (without the MAX_SNAPSHOT_GAP rule)
+	  * have erased the snapshot with this sequence number by now?
+	  * The snapshot 'seqNum' is erased at 'count = seqNum + d' with 'd' the
+	  * i-th distance used in dropOldSnapshots(), but only when 'count + N'
+	  * ends with more than i one-bits.
+	  */
+	template<unsigned N>
+	bool isDropped(unsigned seqNum, unsigned count)
+	{
+		unsigned d = N;
+		unsigned d2 = 2 * N + 1;
+		for (unsigned mask = 1; seqNum + d <= count; mask = 2 * mask + 1) {
+			if (((seqNum + d + N) & mask) == mask) return true;
+			d += d2;
+			d2 *= 2;
+		}
+		return false;
+	}
+
+	/** Erase the snapshots before the MAX_GAP_WINDOW that were skipped by
+	  * dropOldSnapshots(). That is the snapshots that were needed for the
+	  * MAX_SNAPSHOT_GAP rule when it was their turn, and the extra
+	  * snapshots that were added to fill a gap. This way the snapshots
+	  * before the window are a subset of what dropOldSnapshots() alone
+	  * would keep, so memory usage still only grows logarithmically with
+	  * the length of the history.
+	  * Should be called after dropOldSnapshots<N>(count).
+	  */
+	template<unsigned N, typename Chunks>
+	void dropOutOfWindow(Chunks& chunks, unsigned count)
+	{
+		if (chunks.empty()) return;
+		// never erase the very oldest snapshot
+		auto it = std::next(begin(chunks));
+		while ((it != end(chunks)) &&
+		       !inMaxGapWindow(chunks, it->second.time)) {
+			if (isDropped<N>(it->first, count)) {
+				it = chunks.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+} // namespace ReverseSnapshotPruning
+} // namespace openmsx
+
+#endif
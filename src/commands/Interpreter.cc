@@ -241,6 +241,16 @@ void Interpreter::unsetVariable(const char* name)
 	Tcl_UnsetVar(interp, name, TCL_GLOBAL_ONLY);
 }
 
+bool Interpreter::getIntVariable(const char* name, int64_t& result)
+{
+	Tcl_Obj* obj = Tcl_GetVar2Ex(interp, name, nullptr, TCL_GLOBAL_ONLY);
+	if (!obj) return false;
+	Tcl_WideInt value;
+	if (Tcl_GetWideIntFromObj(nullptr, obj, &value) != TCL_OK) return false;
+	result = value;
+	return true;
+}
+
 static TclObject getSafeValue(BaseSetting& setting)
 {
 	try {
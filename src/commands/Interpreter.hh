@@ -4,6 +4,7 @@
 #include "TclParser.hh"
 #include "TclObject.hh"
 #include "string_view.hh"
+#include <cstdint>
 #include <vector>
 #include <tcl.h>
 
@@ -34,6 +35,11 @@ public:
 
 	void setVariable(const TclObject& name, const TclObject& value);
 	void unsetVariable(const char* name);
+	/** Get the value of a global variable as a (64-bit) integer.
+	  * @return false when the variable doesn't exist or doesn't hold an
+	  *         integer.
+	  */
+	bool getIntVariable(const char* name, int64_t& result);
 	void registerSetting(BaseSetting& variable);
 	void unregisterSetting(BaseSetting& variable);
 
@@ -1,22 +1,80 @@
 #include "BreakPointBase.hh"
+#include "CompiledCondition.hh"
 #include "CommandException.hh"
+#include "Debuggable.hh"
+#include "Debugger.hh"
 #include "GlobalCliComm.hh"
+#include "Interpreter.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXMotherBoard.hh"
 #include "ScopedAssign.hh"
 
 namespace openmsx {
 
+namespace {
+
+// Gives the compiled condition access to the machine that hit the
+// breakpoint.
+class MachineContext final : public CompiledCondition::Context
+{
+public:
+	MachineContext(MSXMotherBoard& motherBoard_, Interpreter& interp_)
+		: motherBoard(motherBoard_), interp(interp_)
+	{
+	}
+
+	bool readDebuggable(string_view name, int64_t address,
+	                    int64_t& result) override
+	{
+		auto* debuggable = motherBoard.getDebugger().findDebuggable(name);
+		if (!debuggable || (address < 0) ||
+		    (address >= debuggable->getSize())) {
+			return false;
+		}
+		result = debuggable->read(unsigned(address));
+		return true;
+	}
+
+	bool getVariable(const std::string& name, int64_t& result) override
+	{
+		return interp.getIntVariable(name.c_str(), result);
+	}
+
+	void getSelectedSlot(unsigned page, int& ps, int& ss) override
+	{
+		auto& cpuInterface = motherBoard.getCPUInterface();
+		ps = cpuInterface.getPrimarySlot(page);
+		ss = cpuInterface.isExpanded(ps)
+		   ? cpuInterface.getSecondarySlot(page) : -1;
+	}
+
+private:
+	MSXMotherBoard& motherBoard;
+	Interpreter& interp;
+};
+
+} // namespace
+
 BreakPointBase::BreakPointBase(TclObject command_, TclObject condition_)
 	: command(std::move(command_)), condition(std::move(condition_))
+	, compiled(CompiledCondition::compile(condition.getString()))
 	, executing(false)
 {
 }
 
-bool BreakPointBase::isTrue(GlobalCliComm& cliComm, Interpreter& interp) const
+bool BreakPointBase::isTrue(GlobalCliComm& cliComm, Interpreter& interp,
+                            MSXMotherBoard& motherBoard) const
 {
 	if (condition.getString().empty()) {
 		// unconditional bp
 		return true;
 	}
+	if (compiled) {
+		MachineContext context(motherBoard, interp);
+		bool result;
+		if (compiled->evaluate(context, result)) return result;
+		// e.g. an unset variable, let Tcl produce the error message
+	}
 	try {
 		return condition.evalBool(interp);
 	} catch (CommandException& e) {
@@ -25,14 +83,15 @@ bool BreakPointBase::isTrue(GlobalCliComm& cliComm, Interpreter& interp) const
 	}
 }
 
-void BreakPointBase::checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp)
+void BreakPointBase::checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp,
+                                     MSXMotherBoard& motherBoard)
 {
 	if (executing) {
 		// no recursive execution
 		return;
 	}
 	ScopedAssign<bool> sa(executing, true);
-	if (isTrue(cliComm, interp)) {
+	if (isTrue(cliComm, interp, motherBoard)) {
 		try {
 			command.executeCommand(interp, true); // compile command
 		} catch (CommandException& e) {
@@ -3,11 +3,14 @@
 
 #include "TclObject.hh"
 #include "string_view.hh"
+#include <memory>
 
 namespace openmsx {
 
 class Interpreter;
 class GlobalCliComm;
+class MSXMotherBoard;
+class CompiledCondition;
 
 /** Base class for CPU break and watch points.
  */
@@ -19,7 +22,8 @@ public:
 	TclObject getConditionObj() const { return condition; }
 	TclObject getCommandObj()   const { return command; }
 
-	void checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp);
+	void checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp,
+	                     MSXMotherBoard& motherBoard);
 
 protected:
 	// Note: we require GlobalCliComm here because breakpoint objects can
@@ -28,10 +32,14 @@ protected:
 	BreakPointBase(TclObject command, TclObject condition);
 
 private:
-	bool isTrue(GlobalCliComm& cliComm, Interpreter& interp) const;
+	bool isTrue(GlobalCliComm& cliComm, Interpreter& interp,
+	            MSXMotherBoard& motherBoard) const;
 
 	TclObject command;
 	TclObject condition;
+	// The condition compiled to native code, or nullptr when it's not
+	// in the supported subset. Shared because breakpoints get copied.
+	std::shared_ptr<const CompiledCondition> compiled;
 	bool executing;
 };
 
@@ -165,6 +165,9 @@
 #include "CliComm.hh"
 #include "TclCallback.hh"
 #include "Dasm.hh"
+#include "CPUTraceBuffer.hh"
+#include "CPUProfiler.hh"
+#include "CPUCoverage.hh"
 #include "Z80.hh"
 #include "R800.hh"
 #include "Thread.hh"
@@ -284,6 +287,9 @@ static constexpr Table table = initTables();
 // the (logical) lifetime of this variable cannot overlap between execution
 // of two MSX machines.
 static word start_pc;
+// Only used for profiling.
+static word start_sp;
+static uint64_t start_time;
 
 // conditions
 struct CondC  { bool operator()(byte f) const { return  (f & C_FLAG) != 0; } };
@@ -328,6 +334,12 @@ template<class T> CPUCore<T>::CPUCore(
 	, nmiEdge(false)
 	, exitLoop(false)
 	, tracingEnabled(traceSetting.getBoolean())
+	, traceBuffer(nullptr)
+	, profiler(nullptr)
+	, coverage(nullptr)
+	, memoryCounters(nullptr)
+	, checkBreakPointFetch(false)
+	, breakPointsGeneration(0)
 	, isTurboR(motherboard.isTurboR())
 {
 	static_assert(!std::is_polymorphic<CPUCore<T>>::value,
@@ -355,6 +367,13 @@ template<class T> void CPUCore<T>::invalidateMemCache(unsigned start, unsigned s
 	memset(&writeCacheLine [first], 0, num * sizeof(byte*)); //
 	memset(&readCacheTried [first], 0, num * sizeof(bool));  // FALSE
 	memset(&writeCacheTried[first], 0, num * sizeof(bool));  //
+
+	unsigned firstPage = start / CacheLine::PAGE_SIZE;
+	unsigned endPage = (start + size + CacheLine::PAGE_SIZE - 1) / CacheLine::PAGE_SIZE;
+	for (unsigned page = firstPage; page < endPage; ++page) {
+		readCachePageTried [page] = false;
+		writeCachePageTried[page] = false;
+	}
 }
 
 template<class T> void CPUCore<T>::doReset(EmuTime::param time)
@@ -456,6 +475,50 @@ template<class T> void CPUCore<T>::setSlowInstructions()
 	T::disableLimit();
 }
 
+template<class T> void CPUCore<T>::syncBreakPoints()
+{
+	// Cache lines that contain a breakpoint are never cached for reading
+	// (see MSXCPUInterface::isReadCacheAllowed()), but lines that were
+	// cached before the breakpoint was set must be dropped.
+	unsigned generation = interface->getBreakPointsGeneration();
+	if (generation != breakPointsGeneration) {
+		breakPointsGeneration = generation;
+		invalidateMemCache(0x0000, 0x10000);
+	}
+}
+
+// Called at the start of every executed instruction, from both the fast and
+// the slow CPU loop.
+template<class T> ALWAYS_INLINE void CPUCore<T>::markCoverage(unsigned address)
+{
+	if (unlikely(coverage != nullptr)) {
+		coverage->instruction(address);
+	}
+}
+
+// Count 'num' accesses in the cache line of the given address.
+template<class T> ALWAYS_INLINE void CPUCore<T>::countRead(unsigned address, unsigned num)
+{
+	if (unlikely(memoryCounters != nullptr)) {
+		memoryCounters[address >> CacheLine::BITS] += num;
+	}
+}
+template<class T> ALWAYS_INLINE void CPUCore<T>::countWrite(unsigned address, unsigned num)
+{
+	if (unlikely(memoryCounters != nullptr)) {
+		memoryCounters[CacheLine::NUM + (address >> CacheLine::BITS)] += num;
+	}
+}
+
+template<class T> inline bool CPUCore<T>::isBreakPointFetch(unsigned address) const
+{
+	// Opcode fetches from a cached line never hit a breakpoint, so in the
+	// fast loop only the uncached fetches need to look at the bitmap.
+	return unlikely(checkBreakPointFetch) &&
+	       !readCacheLine[address >> CacheLine::BITS] &&
+	       interface->isBreakPointAddress(address);
+}
+
 template<class T> void CPUCore<T>::raiseIRQ()
 {
 	assert(IRQStatus >= 0);
@@ -598,11 +661,38 @@ template<class T> inline void CPUCore<T>::WRITE_PORT(unsigned port, byte value,
 	// note: no forced page-break after IO
 }
 
+template<class T> void CPUCore<T>::fillReadCachePage(unsigned address)
+{
+	// Plain RAM can hand out a whole 16kB page at once, that saves one
+	// getReadCacheLine() call for each of the other lines in the page.
+	unsigned page = address / CacheLine::PAGE_SIZE;
+	readCachePageTried[page] = true;
+	unsigned pageBase = page * CacheLine::PAGE_SIZE;
+	const byte* mem = interface->getReadCachePage(pageBase);
+	if (!mem) return;
+	unsigned first = pageBase >> CacheLine::BITS;
+	for (unsigned i = 0; i < CacheLine::PAGE_NUM; ++i) {
+		unsigned addrBase = pageBase + i * CacheLine::SIZE;
+		if (interface->isReadCacheAllowed(addrBase)) {
+			// lines with watchpoints (or similar) stay uncached
+			readCacheLine[first + i] = mem - pageBase;
+		}
+	}
+}
+
 template<class T> template<bool PRE_PB, bool POST_PB>
 NEVER_INLINE byte CPUCore<T>::RDMEMslow(unsigned address, unsigned cc)
 {
 	// not cached
 	unsigned high = address >> CacheLine::BITS;
+	if (!readCachePageTried[address / CacheLine::PAGE_SIZE]) {
+		fillReadCachePage(address);
+		if (const byte* line = readCacheLine[high]) {
+			T::template PRE_MEM<PRE_PB, POST_PB>(address);
+			T::template POST_MEM<       POST_PB>(address);
+			return line[address];
+		}
+	}
 	if (!readCacheTried[high]) {
 		// try to cache now
 		unsigned addrBase = address & CacheLine::HIGH;
@@ -626,6 +716,7 @@ NEVER_INLINE byte CPUCore<T>::RDMEMslow(unsigned address, unsigned cc)
 template<class T> template<bool PRE_PB, bool POST_PB>
 ALWAYS_INLINE byte CPUCore<T>::RDMEM_impl2(unsigned address, unsigned cc)
 {
+	countRead(address);
 	const byte* line = readCacheLine[address >> CacheLine::BITS];
 	if (likely(line != nullptr)) {
 		// cached, fast path
@@ -677,6 +768,7 @@ ALWAYS_INLINE unsigned CPUCore<T>::RD_WORD_impl2(unsigned address, unsigned cc)
 		// fast path: cached and two bytes in same cache line
 		T::template PRE_WORD<PRE_PB, POST_PB>(address);
 		T::template POST_WORD<       POST_PB>(address);
+		countRead(address, 2);
 		return Endian::read_UA_L16(&line[address]);
 	} else {
 		// slow path, not inline
@@ -701,11 +793,37 @@ template<class T> ALWAYS_INLINE unsigned CPUCore<T>::RD_WORD(
 	return RD_WORD_impl<true, true>(address, cc);
 }
 
+template<class T> void CPUCore<T>::fillWriteCachePage(unsigned address)
+{
+	// see fillReadCachePage()
+	unsigned page = address / CacheLine::PAGE_SIZE;
+	writeCachePageTried[page] = true;
+	unsigned pageBase = page * CacheLine::PAGE_SIZE;
+	byte* mem = interface->getWriteCachePage(pageBase);
+	if (!mem) return;
+	unsigned first = pageBase >> CacheLine::BITS;
+	for (unsigned i = 0; i < CacheLine::PAGE_NUM; ++i) {
+		unsigned addrBase = pageBase + i * CacheLine::SIZE;
+		if (interface->isWriteCacheAllowed(addrBase)) {
+			writeCacheLine[first + i] = mem - pageBase;
+		}
+	}
+}
+
 template<class T> template<bool PRE_PB, bool POST_PB>
 NEVER_INLINE void CPUCore<T>::WRMEMslow(unsigned address, byte value, unsigned cc)
 {
 	// not cached
 	unsigned high = address >> CacheLine::BITS;
+	if (!writeCachePageTried[address / CacheLine::PAGE_SIZE]) {
+		fillWriteCachePage(address);
+		if (byte* line = writeCacheLine[high]) {
+			T::template PRE_MEM<PRE_PB, POST_PB>(address);
+			T::template POST_MEM<       POST_PB>(address);
+			line[address] = value;
+			return;
+		}
+	}
 	if (!writeCacheTried[high]) {
 		// try to cache now
 		unsigned addrBase = address & CacheLine::HIGH;
@@ -730,6 +848,7 @@ template<class T> template<bool PRE_PB, bool POST_PB>
 ALWAYS_INLINE void CPUCore<T>::WRMEM_impl2(
 	unsigned address, byte value, unsigned cc)
 {
+	countWrite(address);
 	byte* line = writeCacheLine[address >> CacheLine::BITS];
 	if (likely(line != nullptr)) {
 		// cached, fast path
@@ -768,6 +887,7 @@ template<class T> ALWAYS_INLINE void CPUCore<T>::WR_WORD(
 		// fast path: cached and two bytes in same cache line
 		T::template PRE_WORD<true, true>(address);
 		T::template POST_WORD<     true>(address);
+		countWrite(address, 2);
 		Endian::write_UA_L16(&line[address], value);
 	} else {
 		// slow path, not inline
@@ -792,6 +912,7 @@ ALWAYS_INLINE void CPUCore<T>::WR_WORD_rev2(
 		// fast path: cached and two bytes in same cache line
 		T::template PRE_WORD<PRE_PB, POST_PB>(address);
 		T::template POST_WORD<       POST_PB>(address);
+		countWrite(address, 2);
 		Endian::write_UA_L16(&line[address], value);
 	} else {
 		// slow path, not inline
@@ -911,12 +1032,14 @@ void CPUCore<T>::executeInstructions()
 	T::add(ii.cycles); \
 	T::R800Refresh(*this); \
 	if (likely(!T::limitReached())) { \
-		incR(1); \
 		unsigned address = getPC(); \
 		const byte* line = readCacheLine[address >> CacheLine::BITS]; \
 		if (likely(line != nullptr)) { \
+			incR(1); \
 			T::template PRE_MEM<false, false>(address); \
 			T::template POST_MEM<      false>(address); \
+			markCoverage(address); \
+			countRead(address); \
 			byte op = line[address]; \
 			goto *(opcodeTable[op]); \
 		} else { \
@@ -949,7 +1072,7 @@ void CPUCore<T>::executeInstructions()
 	setPC(getPC() + ii.length); \
 	T::add(ii.cycles); \
 	T::R800Refresh(*this); \
-	if (likely(!T::limitReached())) { \
+	if (likely(!T::limitReached()) && !isBreakPointFetch(getPC())) { \
 		goto start; \
 	} \
 	return;
@@ -975,6 +1098,7 @@ void CPUCore<T>::executeInstructions()
 #ifndef USE_COMPUTED_GOTO
 start:
 #endif
+	markCoverage(getPC());
 	unsigned ixy; // for dd_cb/fd_cb
 	byte opcodeMain = RDMEM_OPCODE<0>(T::CC_MAIN);
 	incR(1);
@@ -983,6 +1107,13 @@ start:
 
 fetchSlow: {
 	unsigned address = getPC();
+	if (isBreakPointFetch(address)) {
+		// stop before this instruction, execute2() handles it
+		return;
+	}
+	incR(1);
+	markCoverage(address);
+	countRead(address);
 	byte opcodeSlow = RDMEMslow<false, false>(address, T::CC_MAIN);
 	goto *(opcodeTable[opcodeSlow]);
 }
@@ -2462,15 +2593,49 @@ xx_cb: {
 template<class T> inline void CPUCore<T>::cpuTracePre()
 {
 	start_pc = getPC();
+	if (unlikely(profiler != nullptr)) {
+		start_sp = getSP();
+		start_time = (T::getTimeFast() - EmuTime::zero).length();
+	}
 }
 template<class T> inline void CPUCore<T>::cpuTracePost()
 {
 	if (unlikely(tracingEnabled)) {
 		cpuTracePost_slow();
 	}
+	if (unlikely(profiler != nullptr)) {
+		EmuDuration duration((T::getTimeFast() - EmuTime::zero).length()
+		                     - start_time);
+		profiler->instruction(start_pc, start_sp, getPC(), getSP(),
+		                      duration.getTicksAt(T::getFreq()));
+	}
 }
 template<class T> void CPUCore<T>::cpuTracePost_slow()
 {
+	if (traceBuffer) {
+		// Binary record, only disassembled when it's actually looked
+		// at. This is fast enough to trace long runs.
+		auto& r = traceBuffer->next();
+		EmuTime time = T::getTimeFast();
+		r.time = (time - EmuTime::zero).length();
+		r.pc = start_pc;
+		for (unsigned i = 0; i < 4; ++i) {
+			word addr = start_pc + i;
+			const byte* line = readCacheLine[addr >> CacheLine::BITS];
+			r.opcode[i] = line ? line[addr] : interface->peekMem(addr, time);
+		}
+		r.cpu = std::is_same<T, R800TYPE>::value;
+		r.reserved = 0;
+		r.af = getAF();
+		r.bc = getBC();
+		r.de = getDE();
+		r.hl = getHL();
+		r.ix = getIX();
+		r.iy = getIY();
+		r.sp = getSP();
+		r.reserved2 = 0;
+		return;
+	}
 	byte opbuf[4];
 	string dasmOutput;
 	dasm(*interface, start_pc, opbuf, dasmOutput, T::getTimeFast());
@@ -2592,15 +2757,35 @@ template<class T> void CPUCore<T>::execute2(bool fastForward)
 	// deciding between executeFast() and executeSlow() (because a
 	// SyncPoint could set an IRQ and then we must choose executeSlow())
 	if (fastForward ||
-	    (!interface->anyBreakPoints() && !tracingEnabled)) {
-		// fast path, no breakpoints, no tracing
+	    (!interface->anyConditions() && !tracingEnabled && !profiler)) {
+		// fast path, no conditions, no tracing, no profiling
+		// Breakpoints only need to be checked when an opcode is fetched
+		// from an uncached line, so they're (almost) free until one is
+		// actually reached.
+		checkBreakPointFetch = !fastForward && interface->anyBreakPoints();
+		if (checkBreakPointFetch) syncBreakPoints();
 		while (!needExitCPULoop()) {
-			if (slowInstructions) {
+			if (isBreakPointFetch(getPC())) {
+				if (interface->checkBreakPoints(getPC(), motherboard)) {
+					assert(interface->isBreaked());
+					break;
+				}
+				// Not breaked (e.g. the condition was false),
+				// execute this instruction without checking it
+				// again.
+				if (slowInstructions) --slowInstructions;
+				T::disableLimit();
+				executeSlow();
+				scheduler.schedule(T::getTimeFast());
+				// the breakpoint command may have changed them
+				syncBreakPoints();
+			} else if (slowInstructions) {
 				--slowInstructions;
 				executeSlow();
 				scheduler.schedule(T::getTimeFast());
 			} else {
 				while (slowInstructions == 0) {
+					if (isBreakPointFetch(getPC())) break;
 					T::enableLimit(); // does CPUClock::sync()
 					if (likely(!T::limitReached())) {
 						// multiple instructions
@@ -2615,6 +2800,7 @@ template<class T> void CPUCore<T>::execute2(bool fastForward)
 			}
 		}
 	} else {
+		checkBreakPointFetch = false;
 		while (!needExitCPULoop()) {
 			if (interface->checkBreakPoints(getPC(), motherboard)) {
 				assert(interface->isBreaked());
@@ -11,12 +11,16 @@
 #include "openmsx.hh"
 #include "span.hh"
 #include <atomic>
+#include <cstdint>
 #include <string>
 #include <memory>
 
 namespace openmsx {
 
 class MSXCPUInterface;
+class CPUTraceBuffer;
+class CPUProfiler;
+class CPUCoverage;
 class Scheduler;
 class MSXMotherBoard;
 class TclCallback;
@@ -50,6 +54,30 @@ public:
 
 	void setInterface(MSXCPUInterface* interf) { interface = interf; }
 
+	/** When tracing, record the instructions in the given buffer instead
+	  * of printing them on stdout (nullptr).
+	  */
+	void setTraceBuffer(CPUTraceBuffer* buffer) { traceBuffer = buffer; }
+
+	/** Report every executed instruction to the given profiler (exact
+	  * mode), or to nobody (nullptr). Like tracing this only works in the
+	  * slow CPU loop.
+	  */
+	void setProfiler(CPUProfiler* profiler_) { profiler = profiler_; }
+
+	/** Mark every executed instruction in the given coverage map, or
+	  * don't (nullptr). Unlike tracing this also works in the fast CPU
+	  * loop.
+	  */
+	void setCoverage(CPUCoverage* coverage_) { coverage = coverage_; }
+
+	/** Count the memory reads and writes per cache line in the given
+	  * array (CacheLine::NUM read counters followed by CacheLine::NUM
+	  * write counters), or don't (nullptr). This is done in the cached
+	  * fast path as well, so it doesn't disable the memory cache.
+	  */
+	void setMemoryCounters(uint32_t* counters) { memoryCounters = counters; }
+
 	/**
 	 * Reset the CPU.
 	 */
@@ -117,6 +145,11 @@ private:
 	void execute2(bool fastForward);
 	bool needExitCPULoop();
 	void setSlowInstructions();
+	void syncBreakPoints();
+	inline bool isBreakPointFetch(unsigned address) const;
+	inline void markCoverage(unsigned address);
+	inline void countRead (unsigned address, unsigned num = 1);
+	inline void countWrite(unsigned address, unsigned num = 1);
 	void doSetFreq();
 
 	// Observer<Setting>  !! non-virtual !!
@@ -127,6 +160,8 @@ private:
 	byte* writeCacheLine[CacheLine::NUM];
 	bool readCacheTried [CacheLine::NUM];
 	bool writeCacheTried[CacheLine::NUM];
+	bool readCachePageTried [4]; // getReadCachePage() already tried?
+	bool writeCachePageTried[4]; // getWriteCachePage()
 
 	MSXMotherBoard& motherboard;
 	Scheduler& scheduler;
@@ -158,6 +193,15 @@ private:
 
 	/** In sync with traceSetting.getBoolean(). */
 	bool tracingEnabled;
+	CPUTraceBuffer* traceBuffer; // nullptr -> trace to stdout
+	CPUProfiler* profiler; // can be nullptr
+	CPUCoverage* coverage; // can be nullptr
+	uint32_t* memoryCounters; // can be nullptr
+
+	/** Check opcode fetches against the breakpoints (in the fast loop). */
+	bool checkBreakPointFetch;
+	/** The breakpoints that were known when the cache was last synced. */
+	unsigned breakPointsGeneration;
 
 	/** 'normal' Z80 and Z80 in a turboR behave slightly different */
 	const bool isTurboR;
@@ -172,6 +216,7 @@ private:
 
 	template<bool PRE_PB, bool POST_PB>
 	byte RDMEMslow(unsigned address, unsigned cc);
+	void fillReadCachePage(unsigned address);
 	template<bool PRE_PB, bool POST_PB>
 	inline byte RDMEM_impl2(unsigned address, unsigned cc);
 	template<bool PRE_PB, bool POST_PB>
@@ -192,6 +237,7 @@ private:
 
 	template<bool PRE_PB, bool POST_PB>
 	void WRMEMslow(unsigned address, byte value, unsigned cc);
+	void fillWriteCachePage(unsigned address);
 	template<bool PRE_PB, bool POST_PB>
 	inline void WRMEM_impl2(unsigned address, byte value, unsigned cc);
 	template<bool PRE_PB, bool POST_PB>
@@ -0,0 +1,83 @@
+#include "CPUCoverage.hh"
+#include "Debugger.hh"
+#include "File.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXMotherBoard.hh"
+#include "TclObject.hh"
+#include "strCat.hh"
+
+namespace openmsx {
+
+CPUCoverage::CPUCoverage(MSXMotherBoard& motherBoard_)
+	: motherBoard(motherBoard_)
+	, active(false)
+{
+}
+
+void CPUCoverage::clear()
+{
+	bitmaps.clear();
+	for (auto& r : regions) r = Region();
+}
+
+void CPUCoverage::resolve(unsigned region)
+{
+	auto& r = regions[region];
+	const auto* device = motherBoard.getCPUInterface().getVisibleMSXDevice(region / 2);
+	r = Region();
+	r.valid = true;
+	r.name = device->getName();
+	r.mapper = dynamic_cast<const MSXMemoryMapperInterface*>(device);
+	r.blocks = r.mapper ? nullptr : motherBoard.getDebugger().findDebuggable(
+		strCat(r.name, " romblocks"));
+}
+
+CPUCoverage::Bitmap& CPUCoverage::getBitmap(const std::string& name,
+                                            unsigned block)
+{
+	auto& bitmap = bitmaps[std::make_pair(name, block)];
+	if (!bitmap) bitmap = std::make_unique<Bitmap>();
+	return *bitmap;
+}
+
+size_t CPUCoverage::getCount() const
+{
+	size_t result = 0;
+	for (auto& b : bitmaps) result += b.second->count();
+	return result;
+}
+
+void CPUCoverage::getCoverage(TclObject& result) const
+{
+	for (auto& b : bitmaps) {
+		const auto& bitmap = *b.second;
+		TclObject ranges;
+		unsigned addr = 0;
+		while (addr < 0x10000) {
+			if (!bitmap[addr]) { ++addr; continue; }
+			unsigned first = addr;
+			while ((addr < 0x10000) && bitmap[addr]) ++addr;
+			ranges.addListElement(strCat(hex_string<4>(first), '-',
+			                             hex_string<4>(addr - 1)));
+		}
+		TclObject line;
+		line.addListElement(b.first.first);
+		unsigned block = b.first.second;
+		line.addListElement((block == NO_BLOCK) ? std::string("-")
+		                                        : strCat(block));
+		line.addListElement(ranges);
+		result.addListElement(line);
+	}
+}
+
+void CPUCoverage::save(const std::string& filename) const
+{
+	TclObject coverage;
+	getCoverage(coverage);
+	std::string text;
+	for (auto line : coverage) strAppend(text, line, '\n');
+	File file(filename, File::TRUNCATE);
+	file.write(text.data(), text.size());
+}
+
+} // namespace openmsx
@@ -0,0 +1,100 @@
+#ifndef CPUCOVERAGE_HH
+#define CPUCOVERAGE_HH
+
+#include "Debuggable.hh"
+#include "MSXMapperIO.hh"
+#include "openmsx.hh"
+#include "likely.hh"
+#include <bitset>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+class TclObject;
+
+/** Records which addresses of the MSX code were executed.
+  *
+  * The addresses are grouped per device and per selected block: the ROM
+  * block (via the "<device> romblocks" debuggable) or the memory mapper
+  * segment. So each bank of a mega ROM (or each RAM segment) gets its own
+  * bitmap with one bit per address in the 64kB CPU address space. Only the
+  * first byte of each executed instruction is marked.
+  *
+  * The CPU calls instruction() from both the fast and the slow CPU loop.
+  * The bitmap for the current device and block is cached per 8kB region
+  * (and per region a few recently used blocks), so that e.g. 8kB mega ROM
+  * mappers that alternate between two blocks in one page don't need a
+  * lookup in the map. Coverage is not part of the machine state.
+  */
+class CPUCoverage
+{
+public:
+	static const unsigned NO_BLOCK = unsigned(-1);
+
+	explicit CPUCoverage(MSXMotherBoard& motherBoard);
+
+	void setActive(bool active_) { active = active_; }
+	bool isActive() const { return active; }
+	void clear();
+
+	/** Called by the CPU for every executed instruction. */
+	inline void instruction(word pc) {
+		auto& r = regions[pc >> 13];
+		if (unlikely(!r.valid)) resolve(pc >> 13);
+		unsigned block = r.mapper ? r.mapper->getSelectedSegment(pc >> 14)
+		               : r.blocks ? r.blocks->read(pc)
+		               : NO_BLOCK;
+		auto& entry = r.cache[block & (CACHE_SIZE - 1)];
+		if (unlikely(!entry.bitmap || (block != entry.block))) {
+			entry.block = block;
+			entry.bitmap = &getBitmap(r.name, block);
+		}
+		(*entry.bitmap)[pc] = true;
+	}
+
+	/** Must be called when the device that is visible in the given page
+	  * has changed. */
+	void invalidate(unsigned page) {
+		regions[2 * page + 0] = Region();
+		regions[2 * page + 1] = Region();
+	}
+
+	/** Number of distinct (device, block, address) combinations. */
+	size_t getCount() const;
+	/** For each device and block: {<device> <block> <ranges>}, the
+	  * ranges are formatted as <first>-<last> (hex). */
+	void getCoverage(TclObject& result) const;
+	/** Same as getCoverage(), one line per device and block. */
+	void save(const std::string& filename) const;
+
+private:
+	using Bitmap = std::bitset<0x10000>;
+	static const unsigned CACHE_SIZE = 4; // must be a power of 2
+	struct CacheEntry {
+		unsigned block = NO_BLOCK;
+		Bitmap* bitmap = nullptr;
+	};
+	struct Region { // 8kB
+		bool valid = false;
+		std::string name;
+		const MSXMemoryMapperInterface* mapper = nullptr;
+		Debuggable* blocks = nullptr;
+		CacheEntry cache[CACHE_SIZE];
+	};
+
+	void resolve(unsigned region);
+	Bitmap& getBitmap(const std::string& name, unsigned block);
+
+	MSXMotherBoard& motherBoard;
+	std::map<std::pair<std::string, unsigned>, std::unique_ptr<Bitmap>> bitmaps;
+	Region regions[8];
+	bool active;
+};
+
+} // namespace openmsx
+
+#endif
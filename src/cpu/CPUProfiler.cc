@@ -0,0 +1,271 @@
+#include "CPUProfiler.hh"
+#include "CPURegs.hh"
+#include "Debuggable.hh"
+#include "Debugger.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXMapperIO.hh"
+#include "MSXMotherBoard.hh"
+#include "TclObject.hh"
+#include "strCat.hh"
+#include <algorithm>
+#include <utility>
+
+namespace openmsx {
+
+// A location is an address plus the slot (and optionally the mapper segment)
+// that was visible at that address:
+//   bits  0-15: address
+//   bits 16-23: segment, 0xFF when unknown
+//   bits 24-25: primary slot
+//   bits 26-27: secondary slot
+//   bit     28: primary slot is expanded
+static const uint32_t NO_SEGMENT = 0xFF << 16;
+static const uint32_t ROOT = uint32_t(-1); // caller of the outermost function
+
+static uint64_t callKey(uint32_t caller, uint32_t callee)
+{
+	return (uint64_t(caller) << 32) | callee;
+}
+
+CPUProfiler::CPUProfiler(MSXMotherBoard& motherBoard_, MSXCPU& cpu_)
+	: Schedulable(motherBoard_.getScheduler())
+	, motherBoard(motherBoard_), cpu(cpu_)
+	, rootSelfCycles(0)
+	, totalCount(0), totalCycles(0)
+	, mode(OFF)
+	, expectedPc(0), expectedSp(0)
+{
+}
+
+void CPUProfiler::start(Mode newMode, unsigned samplesPerSecond,
+                        EmuTime::param time)
+{
+	stop();
+	mode = newMode;
+	if (mode == SAMPLE) {
+		samplePeriod = EmuDuration::hz(samplesPerSecond);
+		setSyncPoint(time + samplePeriod);
+	} else if (mode == EXACT) {
+		auto& regs = cpu.getRegisters();
+		expectedPc = regs.getPC();
+		expectedSp = regs.getSP();
+	}
+}
+
+void CPUProfiler::stop()
+{
+	removeSyncPoint();
+	while (!stack.empty()) leave();
+	mode = OFF;
+}
+
+void CPUProfiler::clear()
+{
+	for (auto& counters : exact) counters.reset();
+	samples.clear();
+	functions.clear();
+	calls.clear();
+	stack.clear();
+	rootSelfCycles = 0;
+	totalCount = 0;
+	totalCycles = 0;
+}
+
+uint32_t CPUProfiler::getLocation(word address, bool withSegment) const
+{
+	auto& cpuInterface = motherBoard.getCPUInterface();
+	int page = address >> 14;
+	int ps = cpuInterface.getPrimarySlot(page);
+	uint32_t slot = ps;
+	if (cpuInterface.isExpanded(ps)) {
+		slot |= (cpuInterface.getSecondarySlot(page) << 2) | 0x10;
+	}
+	uint32_t segment = NO_SEGMENT;
+	if (withSegment) {
+		const auto* device = cpuInterface.getVisibleMSXDevice(page);
+		if (auto* mapper = dynamic_cast<const MSXMemoryMapperInterface*>(device)) {
+			segment = mapper->getSelectedSegment(page) << 16;
+		} else if (auto* blocks = motherBoard.getDebugger().findDebuggable(
+				strCat(device->getName(), " romblocks"))) {
+			segment = blocks->read(address) << 16;
+		}
+	}
+	return (slot << 24) | segment | address;
+}
+
+std::string CPUProfiler::formatLocation(uint32_t location)
+{
+	if (location == ROOT) return "-";
+	auto result = strCat((location >> 24) & 3);
+	if (location & (0x10 << 24)) {
+		strAppend(result, '-', (location >> 26) & 3);
+	}
+	if ((location & NO_SEGMENT) != NO_SEGMENT) {
+		strAppend(result, '/', (location >> 16) & 0xFF);
+	}
+	strAppend(result, ':', hex_string<4>(location & 0xFFFF));
+	return result;
+}
+
+void CPUProfiler::instruction(word pc, word sp, word newPc, word newSp,
+                              unsigned cycles)
+{
+	if ((pc != expectedPc) && (sp == word(expectedSp - 2))) {
+		// An interrupt was accepted since the previous instruction,
+		// treat the interrupt routine like a called function.
+		enter(pc, sp);
+	}
+	++totalCount;
+	totalCycles += cycles;
+	auto& counters = exact[getLocation(pc, false) >> 24];
+	if (!counters) counters = std::make_unique<Counters[]>(0x10000);
+	++counters[pc].count;
+	counters[pc].cycles += cycles;
+	if (stack.empty()) {
+		rootSelfCycles += cycles;
+	} else {
+		stack.back().selfCycles += cycles;
+	}
+
+	if ((newSp == word(sp - 2)) && (word(newPc - pc) > 3)) {
+		// a (taken) CALL or RST: pushed the return address and
+		// jumped somewhere else
+		enter(newPc, newSp);
+	} else {
+		// RET, but also e.g. 'POP HL; JP (HL)' or resetting SP
+		while (!stack.empty() && (newSp > stack.back().sp)) {
+			leave();
+		}
+	}
+	expectedPc = newPc;
+	expectedSp = newSp;
+}
+
+void CPUProfiler::enter(word function, word sp)
+{
+	// don't grow without bounds when code never returns (e.g. it
+	// drops the return address)
+	if (stack.size() == 4096) return;
+
+	auto callee = getLocation(function, false);
+	auto caller = stack.empty() ? ROOT : stack.back().function;
+	++functions[callee].calls;
+	++calls[callKey(caller, callee)].count;
+	stack.push_back({callee, sp, totalCycles, 0});
+}
+
+void CPUProfiler::leave()
+{
+	account(stack.size() - 1, functions, calls);
+	stack.pop_back();
+}
+
+// Add the cycles spent in the given frame (so far) to the totals of the
+// function and the call.
+void CPUProfiler::account(size_t frame, Functions& funcs, Calls& cls) const
+{
+	auto function = stack[frame].function;
+	auto cycles = totalCycles - stack[frame].startCycles;
+	auto caller = frame ? stack[frame - 1].function : ROOT;
+	auto& f = funcs[function];
+	f.selfCycles += stack[frame].selfCycles;
+	bool recursive = std::any_of(stack.begin(), stack.begin() + frame,
+		[&](const Frame& fr) { return fr.function == function; });
+	if (!recursive) {
+		// otherwise the outer invocation already includes these
+		f.totalCycles += cycles;
+	}
+	cls[callKey(caller, function)].cycles += cycles;
+}
+
+void CPUProfiler::executeUntil(EmuTime::param time)
+{
+	++totalCount;
+	++samples[getLocation(cpu.getRegisters().getPC(), true)];
+	setSyncPoint(time + samplePeriod);
+}
+
+// Sort on the given key (descending) and keep the first 'num' elements.
+template<typename T, typename Key>
+static void keepHighest(std::vector<T>& v, unsigned num, Key key)
+{
+	num = std::min<unsigned>(num, v.size());
+	std::partial_sort(v.begin(), v.begin() + num, v.end(),
+		[&](const T& x, const T& y) { return key(x) > key(y); });
+	v.resize(num);
+}
+
+void CPUProfiler::getFlatProfile(TclObject& result, unsigned num) const
+{
+	std::vector<std::pair<uint32_t, Counters>> entries;
+	for (uint32_t slot = 0; slot < 32; ++slot) {
+		if (!exact[slot]) continue;
+		for (uint32_t addr = 0; addr < 0x10000; ++addr) {
+			const auto& c = exact[slot][addr];
+			if (c.count) {
+				entries.emplace_back((slot << 24) | NO_SEGMENT | addr, c);
+			}
+		}
+	}
+	for (auto& s : samples) {
+		Counters c;
+		c.count = s.second;
+		entries.emplace_back(s.first, c);
+	}
+	// samples have no cycles
+	keepHighest(entries, num, [](const auto& e) {
+		return e.second.cycles ? e.second.cycles : e.second.count; });
+
+	for (auto& e : entries) {
+		TclObject line;
+		line.addListElement(formatLocation(e.first));
+		line.addListElement(strCat(e.second.count));
+		line.addListElement(strCat(e.second.cycles));
+		result.addListElement(line);
+	}
+}
+
+void CPUProfiler::getFunctions(TclObject& result, unsigned num) const
+{
+	// also include the functions that are still running
+	Functions funcs = functions;
+	Calls cls;
+	for (size_t i = 0; i < stack.size(); ++i) account(i, funcs, cls);
+	if (rootSelfCycles) funcs[ROOT].selfCycles = rootSelfCycles;
+
+	std::vector<std::pair<uint32_t, FunctionCounters>> entries(
+		funcs.begin(), funcs.end());
+	keepHighest(entries, num, [](const auto& e) {
+		return std::max(e.second.totalCycles, e.second.selfCycles); });
+
+	for (auto& e : entries) {
+		TclObject line;
+		line.addListElement(formatLocation(e.first));
+		line.addListElement(strCat(e.second.calls));
+		line.addListElement(strCat(e.second.selfCycles));
+		line.addListElement(strCat(e.second.totalCycles));
+		result.addListElement(line);
+	}
+}
+
+void CPUProfiler::getCalls(TclObject& result, unsigned num) const
+{
+	Functions funcs;
+	Calls cls = calls;
+	for (size_t i = 0; i < stack.size(); ++i) account(i, funcs, cls);
+
+	std::vector<std::pair<uint64_t, Counters>> entries(cls.begin(), cls.end());
+	keepHighest(entries, num, [](const auto& e) { return e.second.cycles; });
+
+	for (auto& e : entries) {
+		TclObject line;
+		line.addListElement(formatLocation(uint32_t(e.first >> 32)));
+		line.addListElement(formatLocation(uint32_t(e.first)));
+		line.addListElement(strCat(e.second.count));
+		line.addListElement(strCat(e.second.cycles));
+		result.addListElement(line);
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,108 @@
+#ifndef CPUPROFILER_HH
+#define CPUPROFILER_HH
+
+#include "Schedulable.hh"
+#include "EmuDuration.hh"
+#include "openmsx.hh"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+class MSXCPU;
+class TclObject;
+
+/** Profiler for the emulated (MSX) code.
+  *
+  * In 'exact' mode the CPU reports every executed instruction (this uses
+  * the same slow CPU loop as breakpoints), the profiler then counts the
+  * executed instructions and cycles per address (and slot). It also keeps
+  * track of the CALL/RST instructions and interrupts to build a call
+  * graph.
+  * In 'sample' mode the program counter is sampled at regular intervals of
+  * emulated time, the CPU itself keeps running at full speed. Samples are
+  * keyed by slot and mapper segment.
+  *
+  * The profile is not part of the machine state, e.g. it's not restored
+  * when going back in time.
+  */
+class CPUProfiler final : private Schedulable
+{
+public:
+	enum Mode { OFF, EXACT, SAMPLE };
+
+	CPUProfiler(MSXMotherBoard& motherBoard, MSXCPU& cpu);
+
+	/** Start profiling, this does not clear previous results. */
+	void start(Mode mode, unsigned samplesPerSecond, EmuTime::param time);
+	void stop();
+	void clear();
+	Mode getMode() const { return mode; }
+	uint64_t getTotalCount() const { return totalCount; }
+	uint64_t getTotalCycles() const { return totalCycles; }
+
+	/** Called by the CPU after every instruction in exact mode. */
+	void instruction(word pc, word sp, word newPc, word newSp,
+	                 unsigned cycles);
+
+	/** For each address: {location count cycles}, highest first. */
+	void getFlatProfile(TclObject& result, unsigned num) const;
+	/** For each function: {function calls self-cycles total-cycles}. */
+	void getFunctions(TclObject& result, unsigned num) const;
+	/** For each caller/callee pair: {caller callee calls total-cycles}. */
+	void getCalls(TclObject& result, unsigned num) const;
+
+private:
+	struct Counters {
+		uint64_t count = 0;
+		uint64_t cycles = 0;
+	};
+	struct FunctionCounters {
+		uint64_t calls = 0;
+		uint64_t selfCycles = 0;
+		uint64_t totalCycles = 0;
+	};
+	struct Frame {
+		uint32_t function;
+		word sp;
+		uint64_t startCycles;
+		uint64_t selfCycles;
+	};
+	using Functions = std::map<uint32_t, FunctionCounters>;
+	using Calls = std::map<uint64_t, Counters>;
+
+	// Schedulable
+	void executeUntil(EmuTime::param time) override;
+
+	uint32_t getLocation(word address, bool withSegment) const;
+	static std::string formatLocation(uint32_t location);
+	void enter(word function, word sp);
+	void leave();
+	void account(size_t frame, Functions& functions, Calls& calls) const;
+
+	MSXMotherBoard& motherBoard;
+	MSXCPU& cpu;
+
+	// exact mode: per slot (see getLocation()), for each address
+	std::unique_ptr<Counters[]> exact[32];
+	// sample mode: per location
+	std::map<uint32_t, uint64_t> samples;
+	Functions functions;
+	Calls calls;
+	std::vector<Frame> stack;
+	uint64_t rootSelfCycles; // not inside any (known) function
+
+	EmuDuration samplePeriod;
+	uint64_t totalCount;
+	uint64_t totalCycles;
+	Mode mode;
+	word expectedPc, expectedSp;
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,54 @@
+#include "CPUTraceBuffer.hh"
+#include "Dasm.hh"
+#include "File.hh"
+#include "Math.hh"
+#include "strCat.hh"
+#include <cassert>
+
+namespace openmsx {
+
+CPUTraceBuffer::CPUTraceBuffer(unsigned capacity_)
+	: capacity(capacity_)
+	, head(0)
+{
+	assert(Math::isPowerOfTwo(capacity));
+}
+
+void CPUTraceBuffer::allocate()
+{
+	records.resize(capacity);
+}
+
+void CPUTraceBuffer::clear()
+{
+	head = 0;
+}
+
+void CPUTraceBuffer::save(const std::string& filename, unsigned num) const
+{
+	num = std::min(num, size());
+	File file(filename, File::TRUNCATE);
+	// the oldest records come first, so write in (at most) two chunks
+	unsigned first = unsigned((head - num) & (capacity - 1));
+	unsigned num1 = std::min(num, capacity - first);
+	if (num1) file.write(&records[first], num1 * sizeof(CPUTraceRecord));
+	if (num1 != num) {
+		file.write(&records[0], (num - num1) * sizeof(CPUTraceRecord));
+	}
+}
+
+std::string CPUTraceBuffer::format(const CPUTraceRecord& r)
+{
+	std::string dasmOutput;
+	dasm(r.opcode, r.pc, dasmOutput);
+	return strCat(hex_string<4>(r.pc), " : ", dasmOutput,
+	              " AF=", hex_string<4>(r.af),
+	              " BC=", hex_string<4>(r.bc),
+	              " DE=", hex_string<4>(r.de),
+	              " HL=", hex_string<4>(r.hl),
+	              " IX=", hex_string<4>(r.ix),
+	              " IY=", hex_string<4>(r.iy),
+	              " SP=", hex_string<4>(r.sp));
+}
+
+} // namespace openmsx
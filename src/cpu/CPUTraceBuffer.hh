@@ -0,0 +1,85 @@
+#ifndef CPUTRACEBUFFER_HH
+#define CPUTRACEBUFFER_HH
+
+#include "openmsx.hh"
+#include "likely.hh"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+/** One executed instruction, as recorded by the 'cputrace' setting when
+  * 'cputrace_output' is set to 'buffer'. The registers are the values
+  * after the instruction was executed (like the textual trace).
+  * This is also the (native endian) format of 'cputrace_buffer save'.
+  */
+struct CPUTraceRecord
+{
+	uint64_t time;     // EmuTime, in MAIN_FREQ ticks since EmuTime::zero
+	uint16_t pc;       // address of the instruction
+	byte opcode[4];    // memory at 'pc', disassembled when needed
+	byte cpu;          // 0 -> Z80, 1 -> R800
+	byte reserved;
+	uint16_t af, bc, de, hl, ix, iy, sp;
+	uint16_t reserved2;
+};
+static_assert(sizeof(CPUTraceRecord) == 32, "keep the file format stable");
+
+/** Fixed size ring buffer of CPUTraceRecords. When full, the oldest
+  * records are overwritten.
+  * Records are only added from the CPU emulation loop and only read by Tcl
+  * commands, both run in the main thread, so no locking is needed.
+  */
+class CPUTraceBuffer
+{
+public:
+	/** @param capacity Maximum number of records, must be a power of 2.
+	  * Memory is only allocated when the first record is added.
+	  */
+	explicit CPUTraceBuffer(unsigned capacity);
+
+	/** Returns the record to fill in for the next instruction. */
+	CPUTraceRecord& next() {
+		if (unlikely(records.empty())) allocate();
+		auto& result = records[head & (capacity - 1)];
+		++head;
+		return result;
+	}
+
+	/** Number of records currently in the buffer. */
+	unsigned size() const {
+		return unsigned(std::min<uint64_t>(head, capacity));
+	}
+
+	/** Total number of records added since the last clear(), including
+	  * the ones that were already overwritten. */
+	uint64_t getTotal() const { return head; }
+
+	/** Access a record, 0 is the oldest one still in the buffer. */
+	const CPUTraceRecord& operator[](unsigned i) const {
+		return records[(head - size() + i) & (capacity - 1)];
+	}
+
+	void clear();
+
+	/** Write the last 'num' records to a file. */
+	void save(const std::string& filename, unsigned num) const;
+
+	/** The textual representation of a record, the same format as
+	  * 'cputrace_output stdout' (without newline).
+	  */
+	static std::string format(const CPUTraceRecord& record);
+
+private:
+	void allocate();
+
+	std::vector<CPUTraceRecord> records;
+	const unsigned capacity;
+	uint64_t head;
+};
+
+} // namespace openmsx
+
+#endif
@@ -10,6 +10,9 @@ static const unsigned NUM  = 0x10000 / SIZE;
 static const unsigned LOW  = SIZE - 1;
 static const unsigned HIGH = 0xFFFF - LOW;
 
+static const unsigned PAGE_SIZE = 0x4000; // a 16kB slot page
+static const unsigned PAGE_NUM  = PAGE_SIZE / SIZE; // cache lines per page
+
 } // namespace CacheLine
 } // namespace openmsx
 
@@ -0,0 +1,726 @@
+#include "CompiledCondition.hh"
+#include "StringOp.hh"
+#include "openmsx.hh"
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace openmsx {
+
+using Value = int64_t;
+using Context = CompiledCondition::Context;
+
+struct CompiledCondition::Node
+{
+	virtual ~Node() = default;
+	virtual bool eval(Context& context, Value& result) const = 0;
+
+	// Some commands (e.g. pc_in_slot) return 'true' instead of '1', such
+	// a result can only be used where Tcl expects a boolean.
+	bool isBoolean = false;
+};
+
+using Node = CompiledCondition::Node;
+using NodePtr = std::unique_ptr<Node>;
+
+namespace {
+
+// thrown when (part of) the expression is not in the supported subset
+struct Unsupported {};
+
+// Tcl promotes integers to bignums instead of wrapping around, so on
+// overflow these return false and the expression is evaluated by Tcl.
+static const Value MIN_VALUE = std::numeric_limits<Value>::min();
+static const Value MAX_VALUE = std::numeric_limits<Value>::max();
+
+static bool addOverflow(Value l, Value r, Value& result)
+{
+	if ((r > 0) ? (l > MAX_VALUE - r) : (l < MIN_VALUE - r)) return true;
+	result = l + r;
+	return false;
+}
+
+static bool subOverflow(Value l, Value r, Value& result)
+{
+	if ((r < 0) ? (l > MAX_VALUE + r) : (l < MIN_VALUE + r)) return true;
+	result = l - r;
+	return false;
+}
+
+static bool mulOverflow(Value l, Value r, Value& result)
+{
+	if (l > 0) {
+		if ((r > 0) ? (l > MAX_VALUE / r) : (r < MIN_VALUE / l)) return true;
+	} else if (l < 0) {
+		if ((r > 0) ? (l < MIN_VALUE / r) : ((r != 0) && (r < MAX_VALUE / l))) return true;
+	}
+	result = l * r;
+	return false;
+}
+
+struct Constant final : Node
+{
+	explicit Constant(Value value_) : value(value_) {}
+
+	bool eval(Context& /*context*/, Value& result) const override
+	{
+		result = value;
+		return true;
+	}
+
+	const Value value;
+};
+
+struct Variable final : Node
+{
+	explicit Variable(std::string name_) : name(std::move(name_)) {}
+
+	bool eval(Context& context, Value& result) const override
+	{
+		return context.getVariable(name, result);
+	}
+
+	const std::string name;
+};
+
+// Reads one or two bytes from a debuggable, like 'debug read' and the
+// 'peek' procs.
+struct Peek final : Node
+{
+	Peek(std::string debuggable_, NodePtr address_,
+	     bool word_, bool bigEndian_, bool isSigned_)
+		: debuggable(std::move(debuggable_)), address(std::move(address_))
+		, word(word_), bigEndian(bigEndian_), isSigned(isSigned_)
+	{
+	}
+
+	bool eval(Context& context, Value& result) const override
+	{
+		Value addr, b0, b1;
+		if (!address->eval(context, addr)) return false;
+		if (!context.readDebuggable(debuggable, addr, b0)) return false;
+		if (!word) {
+			result = (isSigned && (b0 >= 128)) ? (b0 - 256) : b0;
+			return true;
+		}
+		if (!context.readDebuggable(debuggable, addr + 1, b1)) return false;
+		result = bigEndian ? (256 * b0 + b1) : (b0 + 256 * b1);
+		if (isSigned && (result >= 32768)) result -= 65536;
+		return true;
+	}
+
+	const std::string debuggable;
+	const NodePtr address;
+	const bool word, bigEndian, isSigned;
+};
+
+// 'address_in_slot' from _slot.tcl, without the mapper block check.
+struct InSlot final : Node
+{
+	InSlot(NodePtr address_, int ps_, int ss_)
+		: address(std::move(address_)), ps(ps_), ss(ss_)
+	{
+		isBoolean = true;
+	}
+
+	bool eval(Context& context, Value& result) const override
+	{
+		Value addr;
+		if (!address->eval(context, addr)) return false;
+		if ((addr < 0) || (addr > 0xFFFF)) return false;
+		int curPs, curSs;
+		context.getSelectedSlot(unsigned(addr >> 14), curPs, curSs);
+		result = ((ps == -1) || (curPs == ps)) &&
+		         ((ss == -1) || (curSs == -1) || (curSs == ss));
+		return true;
+	}
+
+	const NodePtr address;
+	const int ps, ss; // -1 means "X" (any)
+};
+
+struct Unary final : Node
+{
+	Unary(char op_, NodePtr operand_)
+		: operand(std::move(operand_)), op(op_)
+	{
+		if ((op != '!') && operand->isBoolean) throw Unsupported();
+	}
+
+	bool eval(Context& context, Value& result) const override
+	{
+		Value v;
+		if (!operand->eval(context, v)) return false;
+		switch (op) {
+			case '-': if (subOverflow(0, v, result)) return false; break;
+			case '+': result = v; break;
+			case '~': result = ~v; break;
+			case '!': result = !v; break;
+		}
+		return true;
+	}
+
+	const NodePtr operand;
+	const char op;
+};
+
+enum Op {
+	OP_MUL, OP_DIV, OP_MOD, OP_ADD, OP_SUB, OP_SHL, OP_SHR,
+	OP_LT, OP_GT, OP_LE, OP_GE, OP_EQ, OP_NE,
+	OP_AND, OP_XOR, OP_OR, OP_LAND, OP_LOR
+};
+
+struct Binary final : Node
+{
+	Binary(Op op_, NodePtr left_, NodePtr right_)
+		: left(std::move(left_)), right(std::move(right_)), op(op_)
+	{
+		if ((op != OP_LAND) && (op != OP_LOR) &&
+		    (left->isBoolean || right->isBoolean)) {
+			throw Unsupported();
+		}
+	}
+
+	bool eval(Context& context, Value& result) const override
+	{
+		Value l, r;
+		if (!left->eval(context, l)) return false;
+		if (op == OP_LAND) {
+			if (!l) { result = 0; return true; }
+			if (!right->eval(context, r)) return false;
+			result = r != 0;
+			return true;
+		}
+		if (op == OP_LOR) {
+			if (l) { result = 1; return true; }
+			if (!right->eval(context, r)) return false;
+			result = r != 0;
+			return true;
+		}
+		if (!right->eval(context, r)) return false;
+		switch (op) {
+		case OP_MUL: if (mulOverflow(l, r, result)) return false; break;
+		case OP_ADD: if (addOverflow(l, r, result)) return false; break;
+		case OP_SUB: if (subOverflow(l, r, result)) return false; break;
+		case OP_DIV:
+		case OP_MOD: {
+			if (r == 0) return false;
+			if ((l == std::numeric_limits<Value>::min()) && (r == -1)) {
+				return false;
+			}
+			// Tcl rounds the quotient towards -infinity
+			Value q = l / r;
+			Value m = l % r;
+			if ((m != 0) && ((m < 0) != (r < 0))) {
+				--q;
+				m += r;
+			}
+			result = (op == OP_DIV) ? q : m;
+			break;
+		}
+		case OP_SHL:
+			if ((r < 0) || (r >= 63)) return false;
+			result = Value(uint64_t(l) << r);
+			if ((result >> r) != l) return false; // Tcl would go bignum
+			break;
+		case OP_SHR:
+			if (r < 0) return false;
+			result = (r >= 63) ? ((l < 0) ? -1 : 0) : (l >> r);
+			break;
+		case OP_LT:  result = l <  r; break;
+		case OP_GT:  result = l >  r; break;
+		case OP_LE:  result = l <= r; break;
+		case OP_GE:  result = l >= r; break;
+		case OP_EQ:  result = l == r; break;
+		case OP_NE:  result = l != r; break;
+		case OP_AND: result = l & r; break;
+		case OP_XOR: result = l ^ r; break;
+		case OP_OR:  result = l | r; break;
+		default: break;
+		}
+		return true;
+	}
+
+	const NodePtr left, right;
+	const Op op;
+};
+
+struct Ternary final : Node
+{
+	Ternary(NodePtr cond_, NodePtr ifTrue_, NodePtr ifFalse_)
+		: cond(std::move(cond_))
+		, ifTrue(std::move(ifTrue_)), ifFalse(std::move(ifFalse_))
+	{
+		isBoolean = ifTrue->isBoolean || ifFalse->isBoolean;
+	}
+
+	bool eval(Context& context, Value& result) const override
+	{
+		Value c;
+		if (!cond->eval(context, c)) return false;
+		return (c ? ifTrue : ifFalse)->eval(context, result);
+	}
+
+	const NodePtr cond, ifTrue, ifFalse;
+};
+
+
+// Only the unambiguous integer formats. A leading zero means octal in some
+// Tcl versions and decimal in others, leave those to Tcl.
+static bool parseNumber(string_view s, Value& result)
+{
+	unsigned base = 10;
+	if ((s.size() > 2) && (s[0] == '0')) {
+		switch (s[1]) {
+			case 'x': case 'X': base = 16; break;
+			case 'o': case 'O': base = 8; break;
+			case 'b': case 'B': base = 2; break;
+			default: return false;
+		}
+		s = s.substr(2);
+	} else if ((s.size() > 1) && (s[0] == '0')) {
+		return false;
+	}
+	if (s.empty()) return false;
+
+	const uint64_t max = std::numeric_limits<Value>::max();
+	uint64_t value = 0;
+	for (char c : s) {
+		unsigned digit;
+		if        (('0' <= c) && (c <= '9')) {
+			digit = c - '0';
+		} else if (('a' <= c) && (c <= 'f')) {
+			digit = c - 'a' + 10;
+		} else if (('A' <= c) && (c <= 'F')) {
+			digit = c - 'A' + 10;
+		} else {
+			return false;
+		}
+		if (digit >= base) return false;
+		if (value > (max - digit) / base) return false;
+		value = value * base + digit;
+	}
+	result = Value(value);
+	return true;
+}
+
+static bool isVarNameChar(char c)
+{
+	return (('a' <= c) && (c <= 'z')) || (('A' <= c) && (c <= 'Z')) ||
+	       (('0' <= c) && (c <= '9')) || (c == '_');
+}
+
+// One word of a Tcl command, either a literal string or a substitution.
+struct Word
+{
+	std::string literal;
+	NodePtr node;
+};
+
+struct RegInfo { const char* name; byte index; bool word; };
+static const RegInfo regInfos[] = {
+	// indices in the "CPU regs" debuggable, see _cpuregs.tcl
+	{"A",    0, false}, {"F",    1, false}, {"B",    2, false}, {"C",    3, false},
+	{"D",    4, false}, {"E",    5, false}, {"H",    6, false}, {"L",    7, false},
+	{"A2",   8, false}, {"F2",   9, false}, {"B2",  10, false}, {"C2",  11, false},
+	{"D2",  12, false}, {"E2",  13, false}, {"H2",  14, false}, {"L2",  15, false},
+	{"IXH", 16, false}, {"IXL", 17, false}, {"IYH", 18, false}, {"IYL", 19, false},
+	{"PCH", 20, false}, {"PCL", 21, false}, {"SPH", 22, false}, {"SPL", 23, false},
+	{"I",   24, false}, {"R",   25, false}, {"IM",  26, false}, {"IFF", 27, false},
+	{"AF",   0, true }, {"BC",   2, true }, {"DE",   4, true }, {"HL",   6, true },
+	{"AF2",  8, true }, {"BC2", 10, true }, {"DE2", 12, true }, {"HL2", 14, true },
+	{"IX",  16, true }, {"IY",  18, true }, {"PC",  20, true }, {"SP",  22, true },
+};
+
+struct PeekInfo { const char* name; bool word, bigEndian, isSigned; };
+static const PeekInfo peekInfos[] = {
+	// the procs from _disasm.tcl
+	{"peek",      false, false, false},
+	{"peek8",     false, false, false},
+	{"peek_u8",   false, false, false},
+	{"peek_s8",   false, false, true },
+	{"peek16",    true,  false, false},
+	{"peek16_LE", true,  false, false},
+	{"peek16_BE", true,  true,  false},
+	{"peek_u16",  true,  false, false},
+	{"peek_u16LE",true,  false, false},
+	{"peek_u16BE",true,  true,  false},
+	{"peek_s16",  true,  false, true },
+	{"peek_s16LE",true,  false, true },
+	{"peek_s16BE",true,  true,  true },
+};
+
+class Parser
+{
+public:
+	Parser(string_view str_, unsigned depth_)
+		: str(str_), pos(0), depth(depth_)
+	{
+	}
+
+	NodePtr parse()
+	{
+		auto result = parseTernary();
+		skipSpace();
+		if (pos != str.size()) throw Unsupported();
+		return result;
+	}
+
+private:
+	static const unsigned MAX_DEPTH = 100;
+	static const int NUM_LEVELS = 10;
+
+	bool atEnd() const { return pos == str.size(); }
+	char peekChar(size_t offset = 0) const {
+		return (pos + offset < str.size()) ? str[pos + offset] : '\0';
+	}
+
+	void skipSpace()
+	{
+		while (!atEnd() && strchr(" \t\r\n", str[pos])) ++pos;
+	}
+
+	void expect(char c)
+	{
+		skipSpace();
+		if (peekChar() != c) throw Unsupported();
+		++pos;
+	}
+
+	NodePtr parseTernary()
+	{
+		auto cond = parseBinary(0);
+		skipSpace();
+		if (peekChar() != '?') return cond;
+		++pos;
+		auto ifTrue = parseTernary();
+		expect(':');
+		auto ifFalse = parseTernary();
+		return std::make_unique<Ternary>(
+			std::move(cond), std::move(ifTrue), std::move(ifFalse));
+	}
+
+	// Matches a binary operator of the given precedence level, from
+	// lowest (||) to highest (* / %).
+	bool matchOperator(int level, Op& op)
+	{
+		char c0 = peekChar();
+		char c1 = peekChar(1);
+		int len = 1;
+		switch (level) {
+		case 0:
+			if ((c0 != '|') || (c1 != '|')) return false;
+			op = OP_LOR; len = 2; break;
+		case 1:
+			if ((c0 != '&') || (c1 != '&')) return false;
+			op = OP_LAND; len = 2; break;
+		case 2:
+			if ((c0 != '|') || (c1 == '|')) return false;
+			op = OP_OR; break;
+		case 3:
+			if (c0 != '^') return false;
+			op = OP_XOR; break;
+		case 4:
+			if ((c0 != '&') || (c1 == '&')) return false;
+			op = OP_AND; break;
+		case 5:
+			if (c1 != '=') return false;
+			if      (c0 == '=') op = OP_EQ;
+			else if (c0 == '!') op = OP_NE;
+			else return false;
+			len = 2; break;
+		case 6:
+			if ((c0 != '<') && (c0 != '>')) return false;
+			if (c1 == c0) return false; // shift
+			if (c1 == '=') {
+				op = (c0 == '<') ? OP_LE : OP_GE; len = 2;
+			} else {
+				op = (c0 == '<') ? OP_LT : OP_GT;
+			}
+			break;
+		case 7:
+			if (((c0 != '<') && (c0 != '>')) || (c1 != c0)) return false;
+			op = (c0 == '<') ? OP_SHL : OP_SHR; len = 2; break;
+		case 8:
+			if      (c0 == '+') op = OP_ADD;
+			else if (c0 == '-') op = OP_SUB;
+			else return false;
+			break;
+		case 9:
+			if (c0 == '*') {
+				if (c1 == '*') throw Unsupported(); // exponentiation
+				op = OP_MUL;
+			} else if (c0 == '/') {
+				op = OP_DIV;
+			} else if (c0 == '%') {
+				op = OP_MOD;
+			} else {
+				return false;
+			}
+			break;
+		default:
+			return false;
+		}
+		pos += len;
+		return true;
+	}
+
+	NodePtr parseBinary(int level)
+	{
+		if (level == NUM_LEVELS) return parseUnary();
+		auto left = parseBinary(level + 1);
+		while (true) {
+			skipSpace();
+			Op op = OP_LOR;
+			if (!matchOperator(level, op)) return left;
+			auto right = parseBinary(level + 1);
+			left = std::make_unique<Binary>(
+				op, std::move(left), std::move(right));
+		}
+	}
+
+	NodePtr parseUnary()
+	{
+		if (++depth > MAX_DEPTH) throw Unsupported();
+		skipSpace();
+		NodePtr result;
+		char c = peekChar();
+		if ((c != '\0') && strchr("-+~!", c)) {
+			++pos;
+			result = std::make_unique<Unary>(c, parseUnary());
+		} else {
+			result = parsePrimary();
+		}
+		--depth;
+		return result;
+	}
+
+	NodePtr parsePrimary()
+	{
+		char c = peekChar();
+		if (c == '(') {
+			++pos;
+			auto result = parseTernary();
+			expect(')');
+			return result;
+		} else if (c == '$') {
+			return parseVariable();
+		} else if (c == '[') {
+			return parseCommand();
+		} else if (('0' <= c) && (c <= '9')) {
+			auto begin = pos;
+			while (!atEnd() && (isVarNameChar(str[pos]) || (str[pos] == '.'))) {
+				++pos;
+			}
+			Value value;
+			if (!parseNumber(str.substr(begin, pos - begin), value)) {
+				throw Unsupported(); // e.g. floating point
+			}
+			return std::make_unique<Constant>(value);
+		} else {
+			// strings, math functions, boolean literals, ...
+			throw Unsupported();
+		}
+	}
+
+	NodePtr parseVariable()
+	{
+		++pos; // '$'
+		std::string name;
+		if (peekChar() == '{') {
+			auto len = str.substr(pos).find('}');
+			if (len == string_view::npos) throw Unsupported();
+			name = str.substr(pos + 1, len - 1).str();
+			pos += len + 1;
+		} else {
+			while (true) {
+				if (isVarNameChar(peekChar())) {
+					name += str[pos++];
+				} else if ((peekChar() == ':') && (peekChar(1) == ':')) {
+					name += "::";
+					pos += 2;
+				} else {
+					break;
+				}
+			}
+			if (peekChar() == '(') throw Unsupported(); // array element
+		}
+		if (name.empty()) throw Unsupported();
+		return std::make_unique<Variable>(std::move(name));
+	}
+
+	Word parseWord()
+	{
+		Word word;
+		char c = peekChar();
+		if (c == '{') {
+			auto begin = ++pos;
+			int level = 1;
+			while (true) {
+				if (atEnd()) throw Unsupported();
+				char d = str[pos++];
+				if (d == '\\') throw Unsupported();
+				if (d == '{') ++level;
+				if ((d == '}') && (--level == 0)) break;
+			}
+			word.literal = str.substr(begin, pos - begin - 1).str();
+		} else if (c == '"') {
+			auto begin = ++pos;
+			while (true) {
+				if (atEnd()) throw Unsupported();
+				char d = str[pos++];
+				if (d == '"') break;
+				if (strchr("$[\\", d)) throw Unsupported();
+			}
+			word.literal = str.substr(begin, pos - begin - 1).str();
+		} else if (c == '$') {
+			word.node = parseVariable();
+		} else if (c == '[') {
+			word.node = parseCommand();
+		} else {
+			auto begin = pos;
+			while (!atEnd() && !strchr(" \t]", str[pos])) {
+				if (strchr("$[\\{\";\r\n", str[pos])) throw Unsupported();
+				++pos;
+			}
+			word.literal = str.substr(begin, pos - begin).str();
+		}
+		// words like 'abc$x' are not supported
+		if (!atEnd() && !strchr(" \t]", str[pos])) throw Unsupported();
+		return word;
+	}
+
+	NodePtr parseCommand()
+	{
+		++pos; // '['
+		std::vector<Word> words;
+		while (true) {
+			while (!atEnd() && ((str[pos] == ' ') || (str[pos] == '\t'))) {
+				++pos;
+			}
+			if (atEnd()) throw Unsupported();
+			if (str[pos] == ']') {
+				++pos;
+				break;
+			}
+			words.push_back(parseWord());
+		}
+		return makeCommand(words);
+	}
+
+	static const std::string& getLiteral(const Word& word)
+	{
+		if (word.node) throw Unsupported();
+		return word.literal;
+	}
+
+	static NodePtr getNumber(Word& word)
+	{
+		if (word.node) {
+			if (word.node->isBoolean) throw Unsupported();
+			return std::move(word.node);
+		}
+		Value value;
+		if (!parseNumber(word.literal, value)) throw Unsupported();
+		return std::make_unique<Constant>(value);
+	}
+
+	// A slot number or "X" (-1).
+	static int getSlot(const Word& word)
+	{
+		const auto& s = getLiteral(word);
+		if (s == "X") return -1;
+		Value value;
+		if (!parseNumber(s, value) || (value > 3)) throw Unsupported();
+		return int(value);
+	}
+
+	static NodePtr readPC()
+	{
+		return std::make_unique<Peek>(
+			"CPU regs", std::make_unique<Constant>(20), true, true, false);
+	}
+
+	NodePtr makeCommand(std::vector<Word>& words)
+	{
+		if (words.empty()) throw Unsupported();
+		const auto& cmd = getLiteral(words[0]);
+		auto num = words.size();
+
+		if ((cmd == "reg") && (num == 2)) {
+			const auto& name = getLiteral(words[1]);
+			for (auto& r : regInfos) {
+				if (StringOp::casecmp()(name, r.name)) {
+					return std::make_unique<Peek>(
+						"CPU regs", std::make_unique<Constant>(r.index),
+						r.word, true, false);
+				}
+			}
+			throw Unsupported(); // Tcl gives the error
+		}
+		for (auto& p : peekInfos) {
+			if ((cmd == p.name) && ((num == 2) || (num == 3))) {
+				std::string debuggable = (num == 3) ? getLiteral(words[2])
+				                                    : "memory";
+				return std::make_unique<Peek>(
+					std::move(debuggable), getNumber(words[1]),
+					p.word, p.bigEndian, p.isSigned);
+			}
+		}
+		if ((cmd == "debug") && (num == 4) && (getLiteral(words[1]) == "read")) {
+			return std::make_unique<Peek>(
+				getLiteral(words[2]), getNumber(words[3]),
+				false, false, false);
+		}
+		if ((cmd == "expr") && (num == 2)) {
+			Parser sub(getLiteral(words[1]), depth);
+			return sub.parse();
+		}
+		if (((cmd == "pc_in_slot") || (cmd == "watch_in_slot")) &&
+		    ((num == 2) || (num == 3))) {
+			int ps = getSlot(words[1]);
+			int ss = (num == 3) ? getSlot(words[2]) : -1;
+			NodePtr address = (cmd == "pc_in_slot")
+				? readPC()
+				: NodePtr(std::make_unique<Variable>("::wp_last_address"));
+			return std::make_unique<InSlot>(std::move(address), ps, ss);
+		}
+		throw Unsupported();
+	}
+
+	const string_view str;
+	size_t pos;
+	unsigned depth;
+};
+
+} // namespace
+
+
+CompiledCondition::CompiledCondition(std::unique_ptr<Node> root_)
+	: root(std::move(root_))
+{
+}
+
+CompiledCondition::~CompiledCondition() = default;
+
+std::unique_ptr<CompiledCondition> CompiledCondition::compile(string_view expression)
+{
+	try {
+		Parser parser(expression, 0);
+		return std::unique_ptr<CompiledCondition>(
+			new CompiledCondition(parser.parse()));
+	} catch (Unsupported&) {
+		return nullptr;
+	}
+}
+
+bool CompiledCondition::evaluate(Context& context, bool& result) const
+{
+	Value value;
+	if (!root->eval(context, value)) return false;
+	result = value != 0;
+	return true;
+}
+
+} // namespace openmsx
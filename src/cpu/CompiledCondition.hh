@@ -0,0 +1,72 @@
+#ifndef COMPILEDCONDITION_HH
+#define COMPILEDCONDITION_HH
+
+#include "string_view.hh"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace openmsx {
+
+/** A break/watch point condition that is evaluated without going through
+  * the Tcl interpreter.
+  *
+  * Only a subset of Tcl expressions can be compiled: integer literals,
+  * global variables ($name), the integer operators (except **), the
+  * ?: operator and a few commands that are often used in conditions:
+  *   [reg <name>]
+  *   [peek <addr> ?<debuggable>?] and its variants (peek16, peek_s8, ...)
+  *   [debug read <debuggable> <addr>]
+  *   [expr {<expression>}]
+  *   [pc_in_slot <ps> ?<ss>?] and [watch_in_slot <ps> ?<ss>?]
+  * For anything else compile() returns nullptr and the caller should keep
+  * evaluating the condition in Tcl. Note that this assumes these commands
+  * have their standard implementation (from the bundled scripts).
+  */
+class CompiledCondition
+{
+public:
+	/** Gives access to the state of the machine. */
+	class Context
+	{
+	public:
+		/** Read a byte from a debuggable. Returns false when there's
+		  * no such debuggable or the address is out of range. */
+		virtual bool readDebuggable(string_view name, int64_t address,
+		                            int64_t& result) = 0;
+		/** Get the value of a global Tcl variable. Returns false when
+		  * it doesn't exist or doesn't hold an integer. */
+		virtual bool getVariable(const std::string& name,
+		                         int64_t& result) = 0;
+		/** Get the slot that is selected in the given page. 'ss' is -1
+		  * when the primary slot is not expanded. */
+		virtual void getSelectedSlot(unsigned page, int& ps, int& ss) = 0;
+
+	protected:
+		~Context() = default;
+	};
+
+	struct Node;
+
+	/** Returns nullptr when the expression is not in the supported
+	  * subset. */
+	static std::unique_ptr<CompiledCondition> compile(string_view expression);
+
+	~CompiledCondition();
+
+	/** Returns false when the condition could not be evaluated (e.g. a
+	  * variable doesn't exist or a division by zero). The caller should
+	  * then evaluate it in Tcl, which also gives the proper error
+	  * message.
+	  */
+	bool evaluate(Context& context, bool& result) const;
+
+private:
+	explicit CompiledCondition(std::unique_ptr<Node> root);
+
+	const std::unique_ptr<Node> root;
+};
+
+} // namespace openmsx
+
+#endif
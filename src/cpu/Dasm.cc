@@ -15,35 +15,28 @@ static int abs(unsigned char a)
 	return (a & 128) ? (256 - a) : a;
 }
 
-unsigned dasm(const MSXCPUInterface& interf, word pc, byte buf[4],
-              std::string& dest, EmuTime::param time)
+unsigned dasm(const byte buf[4], word pc, std::string& dest)
 {
 	const char* s;
 	unsigned i = 0;
 	const char* r = nullptr;
 
-	buf[0] = interf.peekMem(pc, time);
 	switch (buf[0]) {
 		case 0xCB:
-			buf[1] = interf.peekMem(pc + 1, time);
 			s = mnemonic_cb[buf[1]];
 			i = 2;
 			break;
 		case 0xED:
-			buf[1] = interf.peekMem(pc + 1, time);
 			s = mnemonic_ed[buf[1]];
 			i = 2;
 			break;
 		case 0xDD:
 		case 0xFD:
 			r = (buf[0] == 0xDD) ? "ix" : "iy";
-			buf[1] = interf.peekMem(pc + 1, time);
 			if (buf[1] != 0xcb) {
 				s = mnemonic_xx[buf[1]];
 				i = 2;
 			} else {
-				buf[2] = interf.peekMem(pc + 2, time);
-				buf[3] = interf.peekMem(pc + 3, time);
 				s = mnemonic_xx_cb[buf[3]];
 				i = 4;
 			}
@@ -56,25 +49,20 @@ unsigned dasm(const MSXCPUInterface& interf, word pc, byte buf[4],
 	for (int j = 0; s[j]; ++j) {
 		switch (s[j]) {
 		case 'B':
-			buf[i] = interf.peekMem(pc + i, time);
 			strAppend(dest, '#', hex_string<2>(
 				static_cast<uint16_t>(buf[i])));
 			i += 1;
 			break;
 		case 'R':
-			buf[i] = interf.peekMem(pc + i, time);
 			strAppend(dest, '#', hex_string<4>(
 				pc + 2 + static_cast<int8_t>(buf[i])));
 			i += 1;
 			break;
 		case 'W':
-			buf[i + 0] = interf.peekMem(pc + i + 0, time);
-			buf[i + 1] = interf.peekMem(pc + i + 1, time);
 			strAppend(dest, '#', hex_string<4>(buf[i] + buf[i + 1] * 256));
 			i += 2;
 			break;
 		case 'X':
-			buf[i] = interf.peekMem(pc + i, time);
 			strAppend(dest, '(', r, sign(buf[i]), '#',
 			     hex_string<2>(abs(buf[i])), ')');
 			i += 1;
@@ -111,4 +99,13 @@ unsigned dasm(const MSXCPUInterface& interf, word pc, byte buf[4],
 	return i;
 }
 
+unsigned dasm(const MSXCPUInterface& interf, word pc, byte buf[4],
+              std::string& dest, EmuTime::param time)
+{
+	for (unsigned i = 0; i < 4; ++i) {
+		buf[i] = interf.peekMem(pc + i, time);
+	}
+	return dasm(buf, pc, dest);
+}
+
 } // namespace openmsx
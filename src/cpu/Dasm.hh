@@ -12,8 +12,9 @@ class MSXCPUInterface;
 /** Disassemble
   * @param interf The CPU interface, used to peek bytes from memory
   * @param pc The position (program counter) where to start disassembling
-  * @param buf The bytes that form this opcode (max 4). The buffer is only
-  *            filled with the min required bytes (see return value)
+  * @param buf The bytes that form this opcode (max 4). The buffer is
+  *            always filled with 4 bytes, only the first 'return value'
+  *            bytes belong to the opcode.
   * @param dest String representation of the disassembled opcode
   * @param time TODO
   * @return Length of the disassembled opcode in bytes
@@ -21,6 +22,12 @@ class MSXCPUInterface;
 unsigned dasm(const MSXCPUInterface& interf, word pc, byte buf[4],
               std::string& dest, EmuTime::param time);
 
+/** Disassemble an opcode that was already read from memory (e.g. from a
+  * CPU trace). Same as above, except that 'buf' is input and must contain
+  * (at least) 4 bytes. 'pc' is only used for relative jumps.
+  */
+unsigned dasm(const byte buf[4], word pc, std::string& dest);
+
 } // namespace openmsx
 
 #endif
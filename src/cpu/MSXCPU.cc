@@ -7,6 +7,10 @@
 #include "Z80.hh"
 #include "R800.hh"
 #include "TclObject.hh"
+#include "CommandException.hh"
+#include "FileContext.hh"
+#include "FileException.hh"
+#include "FileOperations.hh"
 #include "outer.hh"
 #include "serialize.hh"
 #include "unreachable.hh"
@@ -23,6 +27,16 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 	, traceSetting(
 		motherboard.getCommandController(), "cputrace",
 		"CPU tracing on/off", false, Setting::DONT_SAVE)
+	, traceOutputSetting(
+		motherboard.getCommandController(), "cputrace_output",
+		"Where 'cputrace' sends the executed instructions to: printed on "
+		"stdout, or recorded in a binary ring buffer (see cputrace_buffer)",
+		TRACE_STDOUT, EnumSetting<TraceOutput>::Map{
+			{"stdout", TRACE_STDOUT}, {"buffer", TRACE_BUFFER}},
+		Setting::DONT_SAVE)
+	, traceBuffer(1 << 20) // 32MB, only allocated when used
+	, profiler(motherboard, *this)
+	, coverage(motherboard)
 	, diHaltCallback(
 		motherboard.getCommandController(), "di_halt_callback",
 		"Tcl proc called when the CPU executed a DI/HALT sequence")
@@ -41,6 +55,7 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 			motherboard.getMachineInfoCommand(), "r800_freq", *r800)
 		: nullptr)
 	, debuggable(motherboard_)
+	, traceBufferCmd(motherboard.getCommandController())
 	, reference(EmuTime::zero)
 {
 	z80Active = true; // setActiveCPU(CPU_Z80);
@@ -49,6 +64,7 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 	motherboard.getDebugger().setCPU(this);
 	motherboard.getScheduler().setCPU(this);
 	traceSetting.attach(*this);
+	traceOutputSetting.attach(*this);
 
 	z80->freqLocked.attach(*this);
 	z80->freqValue.attach(*this);
@@ -60,6 +76,7 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 
 MSXCPU::~MSXCPU()
 {
+	traceOutputSetting.detach(*this);
 	traceSetting.detach(*this);
 	z80->freqLocked.detach(*this);
 	z80->freqValue.detach(*this);
@@ -141,6 +158,7 @@ void MSXCPU::setNextSyncPoint(EmuTime::param time)
 void MSXCPU::updateVisiblePage(byte page, byte primarySlot, byte secondarySlot)
 {
 	invalidateMemCache(page * 0x4000, 0x4000);
+	coverage.invalidate(page);
 	if (r800) r800->updateVisiblePage(page, primarySlot, secondarySlot);
 }
 
@@ -209,8 +227,44 @@ CPURegs& MSXCPU::getRegisters()
 	}
 }
 
+void MSXCPU::setProfilerMode(CPUProfiler::Mode mode, unsigned samplesPerSecond,
+                             EmuTime::param time)
+{
+	if (mode == CPUProfiler::OFF) {
+		profiler.stop();
+	} else {
+		profiler.start(mode, samplesPerSecond, time);
+	}
+	auto* p = (mode == CPUProfiler::EXACT) ? &profiler : nullptr;
+	          z80 ->setProfiler(p);
+	if (r800) r800->setProfiler(p);
+	exitCPULoopSync();
+}
+
+void MSXCPU::setCoverageActive(bool active)
+{
+	coverage.setActive(active);
+	auto* c = active ? &coverage : nullptr;
+	          z80 ->setCoverage(c);
+	if (r800) r800->setCoverage(c);
+	exitCPULoopSync();
+}
+
+void MSXCPU::setMemoryCounters(uint32_t* counters)
+{
+	          z80 ->setMemoryCounters(counters);
+	if (r800) r800->setMemoryCounters(counters);
+}
+
 void MSXCPU::update(const Setting& setting)
 {
+	if (&setting == &traceOutputSetting) {
+		auto* buffer = (traceOutputSetting.getEnum() == TRACE_BUFFER)
+		             ? &traceBuffer : nullptr;
+		          z80 ->setTraceBuffer(buffer);
+		if (r800) r800->setTraceBuffer(buffer);
+		return;
+	}
 	          z80 ->update(setting);
 	if (r800) r800->update(setting);
 	exitCPULoopSync();
@@ -259,6 +313,83 @@ string MSXCPU::TimeInfoTopic::help(const vector<string>& /*tokens*/) const
 }
 
 
+// class TraceBufferCmd
+
+MSXCPU::TraceBufferCmd::TraceBufferCmd(CommandController& commandController_)
+	: Command(commandController_, "cputrace_buffer")
+{
+}
+
+void MSXCPU::TraceBufferCmd::execute(
+	span<const TclObject> tokens, TclObject& result)
+{
+	auto& buffer = OUTER(MSXCPU, traceBufferCmd).traceBuffer;
+	if (tokens.size() < 2) {
+		throw SyntaxError();
+	}
+	auto& interp = getInterpreter();
+	string_view subCmd = tokens[1].getString();
+	if (subCmd == "size") {
+		if (tokens.size() != 2) throw SyntaxError();
+		result.setInt(buffer.size());
+	} else if (subCmd == "clear") {
+		if (tokens.size() != 2) throw SyntaxError();
+		buffer.clear();
+	} else if (subCmd == "dump") {
+		if (tokens.size() > 3) throw SyntaxError();
+		int num = (tokens.size() == 3) ? tokens[2].getInt(interp) : 100;
+		if (num < 0) throw CommandException("Invalid count");
+		unsigned size = buffer.size();
+		unsigned first = size - std::min<unsigned>(num, size);
+		string text;
+		for (unsigned i = first; i < size; ++i) {
+			strAppend(text, CPUTraceBuffer::format(buffer[i]), '\n');
+		}
+		result.setString(text);
+	} else if (subCmd == "save") {
+		if ((tokens.size() != 3) && (tokens.size() != 4)) {
+			throw SyntaxError();
+		}
+		int num = (tokens.size() == 4) ? tokens[3].getInt(interp)
+		                               : int(buffer.size());
+		if (num < 0) throw CommandException("Invalid count");
+		try {
+			buffer.save(FileOperations::expandTilde(
+				tokens[2].getString()), num);
+		} catch (FileException& e) {
+			throw CommandException(std::move(e).getMessage());
+		}
+	} else {
+		throw CommandException("Invalid subcommand: ", subCmd);
+	}
+}
+
+string MSXCPU::TraceBufferCmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Access the instructions recorded by 'cputrace' when "
+	       "'cputrace_output' is set to 'buffer'. The buffer holds the "
+	       "last 1048576 instructions.\n"
+	       "  cputrace_buffer size                  number of recorded instructions\n"
+	       "  cputrace_buffer dump [<count>]        disassemble the last <count> (default 100) instructions\n"
+	       "  cputrace_buffer save <file> [<count>] save the last <count> (default all) records in binary form\n"
+	       "  cputrace_buffer clear                 forget all recorded instructions\n"
+	       "A saved record is 32 bytes (native endian): 64-bit EmuTime, PC, "
+	       "4 opcode bytes, CPU (0=Z80, 1=R800), 1 unused byte, "
+	       "AF, BC, DE, HL, IX, IY, SP (after the instruction) and 2 unused "
+	       "bytes.";
+}
+
+void MSXCPU::TraceBufferCmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const cmds[] = { "size", "dump", "save", "clear" };
+		completeString(tokens, cmds);
+	} else if ((tokens.size() == 3) && (tokens[1] == "save")) {
+		completeFileName(tokens, userFileContext());
+	}
+}
+
+
 // class CPUFreqInfoTopic
 
 MSXCPU::CPUFreqInfoTopic::CPUFreqInfoTopic(
@@ -3,13 +3,19 @@
 
 #include "InfoTopic.hh"
 #include "SimpleDebuggable.hh"
+#include "Command.hh"
 #include "Observer.hh"
 #include "BooleanSetting.hh"
+#include "EnumSetting.hh"
+#include "CPUTraceBuffer.hh"
+#include "CPUProfiler.hh"
+#include "CPUCoverage.hh"
 #include "EmuTime.hh"
 #include "TclCallback.hh"
 #include "serialize_meta.hh"
 #include "openmsx.hh"
 #include "span.hh"
+#include <cstdint>
 #include <memory>
 
 namespace openmsx {
@@ -115,6 +121,19 @@ public:
 
 	CPURegs& getRegisters();
 
+	/** Start (or stop with CPUProfiler::OFF) profiling the MSX code. */
+	void setProfilerMode(CPUProfiler::Mode mode, unsigned samplesPerSecond,
+	                     EmuTime::param time);
+	CPUProfiler& getProfiler() { return profiler; }
+
+	/** Start or stop recording which instructions get executed. */
+	void setCoverageActive(bool active);
+	CPUCoverage& getCoverage() { return coverage; }
+
+	/** Count the memory accesses per cache line (or stop with nullptr),
+	  * see CPUCore::setMemoryCounters(). */
+	void setMemoryCounters(uint32_t* counters);
+
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
@@ -135,6 +154,11 @@ private:
 
 	MSXMotherBoard& motherboard;
 	BooleanSetting traceSetting;
+	enum TraceOutput { TRACE_STDOUT, TRACE_BUFFER };
+	EnumSetting<TraceOutput> traceOutputSetting;
+	CPUTraceBuffer traceBuffer;
+	CPUProfiler profiler;
+	CPUCoverage coverage;
 	TclCallback diHaltCallback;
 	const std::unique_ptr<CPUCore<Z80TYPE>> z80;
 	const std::unique_ptr<CPUCore<R800TYPE>> r800; // can be nullptr
@@ -165,6 +189,13 @@ private:
 		void write(unsigned address, byte value) override;
 	} debuggable;
 
+	struct TraceBufferCmd final : Command {
+		explicit TraceBufferCmd(CommandController& commandController);
+		void execute(span<const TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} traceBufferCmd;
+
 	EmuTime reference;
 	bool z80Active;
 	bool newZ80Active;
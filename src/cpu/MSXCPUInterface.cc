@@ -44,6 +44,8 @@ bool MSXCPUInterface::breaked = false;
 bool MSXCPUInterface::continued = false;
 bool MSXCPUInterface::step = false;
 MSXCPUInterface::BreakPoints MSXCPUInterface::breakPoints;
+std::bitset<CacheLine::SIZE> MSXCPUInterface::breakPointSet[CacheLine::NUM];
+unsigned MSXCPUInterface::breakPointsGeneration = 0;
 //TODO watchpoints
 MSXCPUInterface::Conditions  MSXCPUInterface::conditions;
 
@@ -61,6 +63,13 @@ MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
 	: memoryDebug       (motherBoard_)
 	, slottedMemoryDebug(motherBoard_)
 	, ioDebug           (motherBoard_)
+	, memoryCountersDebug(motherBoard_, "memory access counters",
+		"Number of CPU reads and writes per 256 byte block of the "
+		"visible memory (only while 'memory_statistics' is enabled).",
+		&memoryCounters[0][0], 2 * CacheLine::NUM)
+	, ioCountersDebug(motherBoard_, "ioport access counters",
+		"Number of CPU reads and writes per IO port.",
+		&ioCounters[0][0], 2 * 256)
 	, slotInfo(motherBoard_.getMachineInfoCommand())
 	, subSlottedInfo(motherBoard_.getMachineInfoCommand())
 	, externalSlotInfo(motherBoard_.getMachineInfoCommand())
@@ -72,11 +81,17 @@ MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
 	, cliComm(motherBoard_.getMSXCliComm())
 	, motherBoard(motherBoard_)
 	, fastForward(false)
+	, memoryStatisticsSetting(
+		motherBoard_.getCommandController(), "memory_statistics",
+		"Count the CPU memory accesses (see the 'memory access "
+		"counters' debuggable)",
+		false, Setting::DONT_SAVE)
 {
 	ranges::fill(primarySlotState, 0);
 	ranges::fill(secondarySlotState, 0);
 	ranges::fill(expanded, 0);
 	ranges::fill(subSlotRegister, 0);
+	ranges::fill(slotSwitchInvalidations, 0);
 	ranges::fill(IO_In,  dummyDevice.get());
 	ranges::fill(IO_Out, dummyDevice.get());
 	ranges::fill(visibleDevices, dummyDevice.get());
@@ -91,6 +106,9 @@ MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
 	// initially allow all regions to be cached
 	memset(disallowReadCache,  0, sizeof(disallowReadCache));
 	memset(disallowWriteCache, 0, sizeof(disallowWriteCache));
+	memset(memoryCounters, 0, sizeof(memoryCounters));
+	memset(ioCounters,     0, sizeof(ioCounters));
+	memoryStatisticsSetting.attach(*this);
 
 	initialPrimarySlots = motherBoard.getMachineConfig()->parseSlotMap();
 	// Note: SlotState is initialised at reset
@@ -121,6 +139,8 @@ MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
 
 MSXCPUInterface::~MSXCPUInterface()
 {
+	memoryStatisticsSetting.detach(*this);
+
 	if (--breakedSettingCount == 0) {
 		assert(breakedSetting);
 		breakedSetting = nullptr;
@@ -585,6 +605,7 @@ ALWAYS_INLINE void MSXCPUInterface::updateVisible(int page, int ps, int ss)
 	MSXDevice* newDevice = slotLayout[ps][ss][page];
 	if (visibleDevices[page] != newDevice) {
 		visibleDevices[page] = newDevice;
+		++slotSwitchInvalidations[page];
 		msxcpu.updateVisiblePage(page, ps, ss);
 	}
 }
@@ -732,13 +753,24 @@ void MSXCPUInterface::insertBreakPoint(const BreakPoint& bp)
 {
 	auto it = ranges::upper_bound(breakPoints, bp, CompareBreakpoints());
 	breakPoints.insert(it, bp);
+	updateBreakPointSet(bp.getAddress());
 }
 
 void MSXCPUInterface::removeBreakPoint(const BreakPoint& bp)
 {
-	auto range = ranges::equal_range(breakPoints, bp.getAddress(), CompareBreakpoints());
+	word address = bp.getAddress(); // 'bp' may be destroyed by erase()
+	auto range = ranges::equal_range(breakPoints, address, CompareBreakpoints());
 	breakPoints.erase(find_if_unguarded(range.first, range.second,
 		[&](const BreakPoint& i) { return &i == &bp; }));
+	updateBreakPointSet(address);
+}
+
+void MSXCPUInterface::updateBreakPointSet(word address)
+{
+	auto range = ranges::equal_range(breakPoints, address, CompareBreakpoints());
+	breakPointSet[address >> CacheLine::BITS][address & CacheLine::LOW] =
+		range.first != range.second;
+	++breakPointsGeneration;
 }
 
 void MSXCPUInterface::checkBreakPoints(
@@ -753,11 +785,11 @@ void MSXCPUInterface::checkBreakPoints(
 	auto& globalCliComm = motherBoard.getReactor().getGlobalCliComm();
 	auto& interp        = motherBoard.getReactor().getInterpreter();
 	for (auto& p : bpCopy) {
-		p.checkAndExecute(globalCliComm, interp);
+		p.checkAndExecute(globalCliComm, interp, motherBoard);
 	}
 	auto condCopy = conditions;
 	for (auto& c : condCopy) {
-		c.checkAndExecute(globalCliComm, interp);
+		c.checkAndExecute(globalCliComm, interp, motherBoard);
 	}
 }
 
@@ -908,7 +940,7 @@ void MSXCPUInterface::executeMemWatch(WatchPoint::Type type,
 		if ((w->getBeginAddress() <= address) &&
 		    (w->getEndAddress()   >= address) &&
 		    (w->getType()         == type)) {
-			w->checkAndExecute(globalCliComm, interp);
+			w->checkAndExecute(globalCliComm, interp, motherBoard);
 		}
 	}
 
@@ -960,6 +992,14 @@ void MSXCPUInterface::doContinue2()
 	motherBoard.getRealTime().resync();
 }
 
+void MSXCPUInterface::update(const Setting& setting)
+{
+	assert(&setting == &memoryStatisticsSetting); (void)setting;
+	// counted by the CPU, also for cached accesses
+	msxcpu.setMemoryCounters(memoryStatisticsSetting.getBoolean()
+	                         ? &memoryCounters[0][0] : nullptr);
+}
+
 void MSXCPUInterface::cleanup()
 {
 	// before the Tcl interpreter is destroyed, we must delete all
@@ -968,6 +1008,8 @@ void MSXCPUInterface::cleanup()
 	// TODO it would be nicer if breakpoints and conditions were not
 	//      global objects.
 	breakPoints.clear();
+	for (auto& s : breakPointSet) s.reset();
+	++breakPointsGeneration;
 	conditions.clear();
 }
 
@@ -1141,6 +1183,28 @@ void MSXCPUInterface::IODebug::write(unsigned address, byte value, EmuTime::para
 }
 
 
+// class CountersDebug
+
+MSXCPUInterface::CountersDebug::CountersDebug(
+		MSXMotherBoard& motherBoard_, const std::string& name_,
+		const std::string& description_, uint32_t* counters_,
+		unsigned num)
+	: SimpleDebuggable(motherBoard_, name_, description_, 4 * num)
+	, counters(counters_)
+{
+}
+
+byte MSXCPUInterface::CountersDebug::read(unsigned address)
+{
+	return counters[address / 4] >> (8 * (address % 4));
+}
+
+void MSXCPUInterface::CountersDebug::write(unsigned address, byte /*value*/)
+{
+	counters[address / 4] = 0;
+}
+
+
 // class IOInfo
 
 MSXCPUInterface::IOInfo::IOInfo(InfoCommand& machineInfoCommand, const char* name_)
@@ -3,6 +3,8 @@
 
 #include "SimpleDebuggable.hh"
 #include "InfoTopic.hh"
+#include "BooleanSetting.hh"
+#include "Observer.hh"
 #include "CacheLine.hh"
 #include "MSXDevice.hh"
 #include "BreakPoint.hh"
@@ -11,6 +13,7 @@
 #include "likely.hh"
 #include "ranges.hh"
 #include <bitset>
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -37,7 +40,7 @@ struct CompareBreakpoints {
 	}
 };
 
-class MSXCPUInterface
+class MSXCPUInterface : private Observer<Setting>
 {
 public:
 	MSXCPUInterface(const MSXCPUInterface&) = delete;
@@ -134,6 +137,7 @@ public:
 	 * @see MSXDevice::readIO()
 	 */
 	inline byte readIO(word port, EmuTime::param time) {
+		++ioCounters[0][port & 0xFF];
 		return IO_In[port & 0xFF]->readIO(port, time);
 	}
 
@@ -142,6 +146,7 @@ public:
 	 * @see MSXDevice::writeIO()
 	 */
 	inline void writeIO(word port, byte value, EmuTime::param time) {
+		++ioCounters[1][port & 0xFF];
 		IO_Out[port & 0xFF]->writeIO(port, value, time);
 	}
 
@@ -158,7 +163,7 @@ public:
 	 * An interval will never contain the address 0xffff.
 	 */
 	inline const byte* getReadCacheLine(word start) const {
-		if (unlikely(disallowReadCache[start >> CacheLine::BITS])) {
+		if (unlikely(!isReadCacheAllowed(start))) {
 			return nullptr;
 		}
 		return visibleDevices[start >> 14]->getReadCacheLine(start);
@@ -183,6 +188,28 @@ public:
 		return visibleDevices[start >> 14]->getWriteCacheLine(start);
 	}
 
+	/**
+	 * Like getReadCacheLine(), but for the complete 16kB page starting at
+	 * 'start' (see MSXDevice::getReadCachePage()). Unlike
+	 * getReadCacheLine() this doesn't check for lines that may not be
+	 * cached (e.g. because of watchpoints), use isReadCacheAllowed() for
+	 * each line in the page.
+	 */
+	inline const byte* getReadCachePage(word start) const {
+		return visibleDevices[start >> 14]->getReadCachePage(start);
+	}
+	inline byte* getWriteCachePage(word start) const {
+		return visibleDevices[start >> 14]->getWriteCachePage(start);
+	}
+	inline bool isReadCacheAllowed(word start) const {
+		// lines with a breakpoint are not cached, see CPUCore
+		unsigned line = start >> CacheLine::BITS;
+		return !disallowReadCache[line] && breakPointSet[line].none();
+	}
+	inline bool isWriteCacheAllowed(word start) const {
+		return !disallowWriteCache[start >> CacheLine::BITS];
+	}
+
 	/**
 	 * CPU uses this method to read 'extra' data from the databus
 	 * used in interrupt routines. In MSX this returns always 255.
@@ -213,6 +240,26 @@ public:
 
 	DummyDevice& getDummyDevice() { return *dummyDevice; }
 
+	/** Number of times the CPU cache for the given page was invalidated
+	  * because a (sub)slot switch made a different device visible. Only
+	  * for instrumentation, wraps around.
+	  */
+	unsigned getSlotSwitchInvalidations(int page) const {
+		return slotSwitchInvalidations[page];
+	}
+
+	/** The primary and secondary slot that are selected in the given
+	  * page. The latter is only meaningful when the primary slot is
+	  * expanded.
+	  */
+	int getPrimarySlot  (int page) const { return primarySlotState  [page]; }
+	int getSecondarySlot(int page) const { return secondarySlotState[page]; }
+
+	/** The device that is visible in the given page. */
+	const MSXDevice* getVisibleMSXDevice(int page) const {
+		return visibleDevices[page];
+	}
+
 	static void insertBreakPoint(const BreakPoint& bp);
 	static void removeBreakPoint(const BreakPoint& bp);
 	using BreakPoints = std::vector<BreakPoint>;
@@ -245,14 +292,30 @@ public:
 	{
 		return !breakPoints.empty() || !conditions.empty();
 	}
+	static bool anyConditions()
+	{
+		return !conditions.empty();
+	}
+	/** Is there a breakpoint (possibly with a condition) at the given
+	  * address? */
+	static bool isBreakPointAddress(unsigned address)
+	{
+		return breakPointSet[address >> CacheLine::BITS]
+		                    [address &  CacheLine::LOW];
+	}
+	/** Changes each time a breakpoint is inserted or removed. */
+	static unsigned getBreakPointsGeneration()
+	{
+		return breakPointsGeneration;
+	}
 	static bool checkBreakPoints(unsigned pc, MSXMotherBoard& motherBoard)
 	{
-		auto range = ranges::equal_range(breakPoints, pc, CompareBreakpoints());
-		if (conditions.empty() && (range.first == range.second)) {
+		if (conditions.empty() && !isBreakPointAddress(pc)) {
 			return false;
 		}
 
 		// slow path non-inlined
+		auto range = ranges::equal_range(breakPoints, pc, CompareBreakpoints());
 		checkBreakPoints(range, motherBoard);
 		return isBreaked();
 	}
@@ -288,6 +351,7 @@ private:
 	static void checkBreakPoints(std::pair<BreakPoints::const_iterator,
 	                                       BreakPoints::const_iterator> range,
 	                             MSXMotherBoard& motherBoard);
+	static void updateBreakPointSet(word address);
 
 	void removeAllWatchPoints();
 	void registerIOWatch  (WatchPoint& watchPoint, MSXDevice** devices);
@@ -298,6 +362,9 @@ private:
 
 	void doContinue2();
 
+	// Observer<Setting>
+	void update(const Setting& setting) override;
+
 	struct MemoryDebug final : SimpleDebuggable {
 		explicit MemoryDebug(MSXMotherBoard& motherBoard);
 		byte read(unsigned address, EmuTime::param time) override;
@@ -316,6 +383,20 @@ private:
 		void write(unsigned address, byte value, EmuTime::param time) override;
 	} ioDebug;
 
+	/** Shows 32-bit (little endian) counters, first the read counters
+	  * then the write counters. Writing a byte resets that counter. */
+	struct CountersDebug final : SimpleDebuggable {
+		CountersDebug(MSXMotherBoard& motherBoard, const std::string& name,
+		              const std::string& description, uint32_t* counters,
+		              unsigned num);
+		byte read(unsigned address) override;
+		void write(unsigned address, byte value) override;
+	private:
+		uint32_t* counters;
+	};
+	CountersDebug memoryCountersDebug;
+	CountersDebug ioCountersDebug;
+
 	struct SlotInfo final : InfoTopic {
 		explicit SlotInfo(InfoCommand& machineInfoCommand);
 		void execute(span<const TclObject> tokens,
@@ -398,11 +479,22 @@ private:
 	byte secondarySlotState[4];
 	byte initialPrimarySlots;
 	unsigned expanded[4];
+	unsigned slotSwitchInvalidations[4]; // no need to serialize
 
 	bool fastForward; // no need to serialize
 
+	// Access statistics, not part of the machine state. Memory accesses
+	// are counted by the CPU, and only while enabled (it costs a little
+	// on every access).
+	BooleanSetting memoryStatisticsSetting;
+	uint32_t memoryCounters[2][CacheLine::NUM]; // read, write
+	uint32_t ioCounters[2][256];                // read, write
+
 	//  All CPUs (Z80 and R800) of all MSX machines share this state.
 	static BreakPoints breakPoints; // sorted on address
+	// one bit per address that has at least one breakpoint
+	static std::bitset<CacheLine::SIZE> breakPointSet[CacheLine::NUM];
+	static unsigned breakPointsGeneration;
 	WatchPoints watchPoints; // ordered in creation order,  TODO must also be static
 	static Conditions conditions; // ordered in creation order
 	static bool breaked;
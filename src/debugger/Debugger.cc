@@ -10,8 +10,13 @@
 #include "MSXWatchIODevice.hh"
 #include "TclObject.hh"
 #include "CommandException.hh"
+#include "Base64.hh"
+#include "FileContext.hh"
+#include "FileException.hh"
+#include "FileOperations.hh"
 #include "MemBuffer.hh"
 #include "ranges.hh"
+#include "sha1.hh"
 #include "stl.hh"
 #include "unreachable.hh"
 #include "view.hh"
@@ -71,6 +76,43 @@ Debuggable& Debugger::getDebuggable(string_view name)
 	return *result;
 }
 
+std::vector<Debugger::BlockSnapshot>& Debugger::getDeltaSnapshots(const string& id)
+{
+	auto it = ranges::find_if(deltaSnapshots, [&](auto& d) { return d.id == id; });
+	if (it != end(deltaSnapshots)) {
+		// move to the back (most recently used)
+		std::rotate(it, it + 1, end(deltaSnapshots));
+	} else {
+		if (deltaSnapshots.size() == MAX_DELTA_IDS) {
+			deltaSnapshots.erase(begin(deltaSnapshots));
+		}
+		deltaSnapshots.push_back({id, {}});
+	}
+	return deltaSnapshots.back().blocks;
+}
+
+Sha1Sum Debugger::getDebuggablesHash()
+{
+	auto names = to_vector<string>(view::keys(debuggables));
+	ranges::sort(names);
+	SHA1 sha1;
+	vector<uint8_t> buf;
+	for (auto& name : names) {
+		auto& debuggable = getDebuggable(name);
+		unsigned size = debuggable.getSize();
+		buf.resize(size);
+		for (unsigned i = 0; i < size; ++i) {
+			buf[i] = debuggable.read(i);
+		}
+		// include the name, so that moving data between debuggables
+		// results in a different hash
+		sha1.update(reinterpret_cast<const uint8_t*>(name.data()),
+		            name.size() + 1);
+		sha1.update(buf.data(), buf.size());
+	}
+	return sha1.digest();
+}
+
 void Debugger::registerProbe(ProbeBase& probe)
 {
 	assert(!probes.contains(probe.getName()));
@@ -218,11 +260,12 @@ bool Debugger::Cmd::needRecord(span<const TclObject> tokens) const
 	// code. See comments in RecordedCommand for more details.
 	if (tokens.size() < 2) return false;
 	string_view subCmd = tokens[1].getString();
-	return (subCmd == "write") || (subCmd == "write_block");
+	return (subCmd == "write") || (subCmd == "write_block") ||
+	       (subCmd == "write_blocks");
 }
 
 void Debugger::Cmd::execute(
-	span<const TclObject> tokens, TclObject& result, EmuTime::param /*time*/)
+	span<const TclObject> tokens, TclObject& result, EmuTime::param time)
 {
 	if (tokens.size() < 2) {
 		throw CommandException("Missing argument");
@@ -232,10 +275,16 @@ void Debugger::Cmd::execute(
 		read(tokens, result);
 	} else if (subCmd == "read_block") {
 		readBlock(tokens, result);
+	} else if (subCmd == "read_blocks") {
+		readBlocks(tokens, result);
+	} else if (subCmd == "release_blocks") {
+		releaseBlocks(tokens, result);
 	} else if (subCmd == "write") {
 		write(tokens, result);
 	} else if (subCmd == "write_block") {
 		writeBlock(tokens, result);
+	} else if (subCmd == "write_blocks") {
+		writeBlocks(tokens, result);
 	} else if (subCmd == "size") {
 		size(tokens, result);
 	} else if (subCmd == "desc") {
@@ -272,6 +321,10 @@ void Debugger::Cmd::execute(
 		listConditions(tokens, result);
 	} else if (subCmd == "probe") {
 		probe(tokens, result);
+	} else if (subCmd == "profile") {
+		profile(tokens, result, time);
+	} else if (subCmd == "coverage") {
+		coverage(tokens, result);
 	} else {
 		throw SyntaxError();
 	}
@@ -337,6 +390,120 @@ void Debugger::Cmd::readBlock(span<const TclObject> tokens, TclObject& result)
 	result.setBinary(buf.data(), num);
 }
 
+static TclObject encodeBlock(byte* data, unsigned num, bool base64)
+{
+	TclObject result;
+	if (base64) {
+		result.setString(Base64::encode(data, num));
+	} else {
+		result.setBinary(data, num);
+	}
+	return result;
+}
+
+// Parse the options of read_blocks and write_blocks, returns the index of
+// the first block.
+static size_t parseBlockOptions(span<const TclObject> tokens, bool& base64,
+                                const TclObject** deltaId)
+{
+	size_t i = 2;
+	for (/**/; i < tokens.size(); ++i) {
+		string_view option = tokens[i].getString();
+		if (option == "-base64") {
+			base64 = true;
+		} else if (deltaId && (option == "-delta")) {
+			if (++i == tokens.size()) throw SyntaxError();
+			*deltaId = &tokens[i];
+		} else {
+			break;
+		}
+	}
+	return i;
+}
+
+void Debugger::Cmd::readBlocks(span<const TclObject> tokens, TclObject& result)
+{
+	bool base64 = false;
+	const TclObject* deltaId = nullptr;
+	size_t i = parseBlockOptions(tokens, base64, &deltaId);
+	if (i == tokens.size()) throw SyntaxError();
+
+	auto& interp = getInterpreter();
+	auto* oldSnapshots = deltaId
+		? &debugger().getDeltaSnapshots(deltaId->getString().str())
+		: nullptr;
+	std::vector<BlockSnapshot> newSnapshots;
+	for (/**/; i < tokens.size(); ++i) {
+		const auto& block = tokens[i];
+		if (block.getListLength(interp) != 3) {
+			throw CommandException(
+				"Expected {<name> <addr> <size>}, got: ",
+				block.getString());
+		}
+		string devName = block.getListIndex(interp, 0).getString().str();
+		Debuggable& device = debugger().getDebuggable(devName);
+		unsigned devSize = device.getSize();
+		unsigned addr = block.getListIndex(interp, 1).getInt(interp);
+		if (addr >= devSize) {
+			throw CommandException("Invalid address");
+		}
+		unsigned num = block.getListIndex(interp, 2).getInt(interp);
+		if (num > (devSize - addr)) {
+			throw CommandException("Invalid size");
+		}
+		vector<byte> buf(num);
+		for (unsigned j = 0; j < num; ++j) {
+			buf[j] = device.read(addr + j);
+		}
+		if (!deltaId) {
+			result.addListElement(encodeBlock(buf.data(), num, base64));
+			continue;
+		}
+
+		// Only return the bytes that changed since the previous call,
+		// as a list of <offset> <bytes> pairs.
+		TclObject changes;
+		auto it = ranges::find_if(*oldSnapshots, [&](auto& s) {
+			return (s.name == devName) && (s.address == addr) &&
+			       (s.data.size() == num);
+		});
+		if (it == end(*oldSnapshots)) {
+			changes.addListElement(TclObject(0));
+			changes.addListElement(encodeBlock(buf.data(), num, base64));
+		} else {
+			// Changes that are close together are merged into one
+			// run, each run has some overhead.
+			static const unsigned MAX_GAP = 16;
+			const auto& old = it->data;
+			unsigned j = 0;
+			while (j < num) {
+				if (old[j] == buf[j]) { ++j; continue; }
+				unsigned first = j;
+				unsigned last = j + 1; // exclusive
+				for (j = last; (j < num) && (j < last + MAX_GAP); ++j) {
+					if (old[j] != buf[j]) last = j + 1;
+				}
+				changes.addListElement(TclObject(int(first)));
+				changes.addListElement(encodeBlock(
+					&buf[first], last - first, base64));
+				j = last;
+			}
+		}
+		result.addListElement(changes);
+		newSnapshots.push_back({std::move(devName), addr, std::move(buf)});
+	}
+	if (oldSnapshots) *oldSnapshots = std::move(newSnapshots);
+}
+
+void Debugger::Cmd::releaseBlocks(span<const TclObject> tokens, TclObject& /*result*/)
+{
+	if (tokens.size() != 3) throw SyntaxError();
+	string_view id = tokens[2].getString();
+	auto& snapshots = debugger().deltaSnapshots;
+	auto it = ranges::find_if(snapshots, [&](auto& s) { return s.id == id; });
+	if (it != end(snapshots)) snapshots.erase(it);
+}
+
 void Debugger::Cmd::write(span<const TclObject> tokens, TclObject& /*result*/)
 {
 	if (tokens.size() != 5) {
@@ -378,6 +545,48 @@ void Debugger::Cmd::writeBlock(span<const TclObject> tokens, TclObject& /*result
 	}
 }
 
+void Debugger::Cmd::writeBlocks(span<const TclObject> tokens, TclObject& /*result*/)
+{
+	bool base64 = false;
+	size_t i = parseBlockOptions(tokens, base64, nullptr);
+	if (i == tokens.size()) throw SyntaxError();
+
+	auto& interp = getInterpreter();
+	for (/**/; i < tokens.size(); ++i) {
+		const auto& block = tokens[i];
+		if (block.getListLength(interp) != 3) {
+			throw CommandException(
+				"Expected {<name> <addr> <values>}, got: ",
+				block.getString());
+		}
+		Debuggable& device = debugger().getDebuggable(
+			block.getListIndex(interp, 0).getString());
+		unsigned devSize = device.getSize();
+		unsigned addr = block.getListIndex(interp, 1).getInt(interp);
+		if (addr >= devSize) {
+			throw CommandException("Invalid address");
+		}
+		TclObject values = block.getListIndex(interp, 2);
+		MemBuffer<byte> decoded;
+		const byte* buf;
+		unsigned num;
+		if (base64) {
+			auto d = Base64::decode(values.getString());
+			decoded = std::move(d.first);
+			buf = decoded.data();
+			num = unsigned(d.second);
+		} else {
+			buf = values.getBinary(num);
+		}
+		if ((num + addr) > devSize) {
+			throw CommandException("Invalid size");
+		}
+		for (unsigned j = 0; j < num; ++j) {
+			device.write(addr + j, buf[j]);
+		}
+	}
+}
+
 void Debugger::Cmd::setBreakPoint(span<const TclObject> tokens, TclObject& result)
 {
 	TclObject command("debug break");
@@ -753,6 +962,98 @@ void Debugger::Cmd::probeListBreakPoints(
 	result.setString(res);
 }
 
+void Debugger::Cmd::profile(span<const TclObject> tokens, TclObject& result,
+                            EmuTime::param time)
+{
+	if (tokens.size() < 3) {
+		throw CommandException("Missing argument");
+	}
+	auto& cpu = *debugger().cpu;
+	auto& profiler = cpu.getProfiler();
+	auto& interp = getInterpreter();
+	string_view subCmd = tokens[2].getString();
+	if (subCmd == "start") {
+		if ((tokens.size() != 4) && (tokens.size() != 5)) {
+			throw SyntaxError();
+		}
+		string_view type = tokens[3].getString();
+		if ((type == "exact") && (tokens.size() == 4)) {
+			cpu.setProfilerMode(CPUProfiler::EXACT, 0, time);
+		} else if (type == "sample") {
+			int rate = (tokens.size() == 5) ? tokens[4].getInt(interp)
+			                                : 10000;
+			if ((rate < 1) || (rate > 1000000)) {
+				throw CommandException("Invalid sample rate: ", rate);
+			}
+			cpu.setProfilerMode(CPUProfiler::SAMPLE, rate, time);
+		} else {
+			throw SyntaxError();
+		}
+	} else if (subCmd == "stop") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cpu.setProfilerMode(CPUProfiler::OFF, 0, time);
+	} else if (subCmd == "clear") {
+		if (tokens.size() != 3) throw SyntaxError();
+		profiler.clear();
+	} else if (subCmd == "status") {
+		if (tokens.size() != 3) throw SyntaxError();
+		static const char* const modes[] = { "off", "exact", "sample" };
+		result.addListElement(modes[profiler.getMode()]);
+		result.addListElement(strCat(profiler.getTotalCount()));
+		result.addListElement(strCat(profiler.getTotalCycles()));
+	} else if ((subCmd == "flat") || (subCmd == "functions") ||
+	           (subCmd == "calls")) {
+		if (tokens.size() > 4) throw SyntaxError();
+		int num = (tokens.size() == 4) ? tokens[3].getInt(interp) : 100;
+		if (num < 0) throw CommandException("Invalid count");
+		if (subCmd == "flat") {
+			profiler.getFlatProfile(result, num);
+		} else if (subCmd == "functions") {
+			profiler.getFunctions(result, num);
+		} else {
+			profiler.getCalls(result, num);
+		}
+	} else {
+		throw SyntaxError();
+	}
+}
+
+void Debugger::Cmd::coverage(span<const TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 3) {
+		throw CommandException("Missing argument");
+	}
+	auto& cpu = *debugger().cpu;
+	auto& cov = cpu.getCoverage();
+	string_view subCmd = tokens[2].getString();
+	if (subCmd == "start") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cpu.setCoverageActive(true);
+	} else if (subCmd == "stop") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cpu.setCoverageActive(false);
+	} else if (subCmd == "clear") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cov.clear();
+	} else if (subCmd == "status") {
+		if (tokens.size() != 3) throw SyntaxError();
+		result.addListElement(cov.isActive() ? "on" : "off");
+		result.addListElement(strCat(cov.getCount()));
+	} else if (subCmd == "list") {
+		if (tokens.size() != 3) throw SyntaxError();
+		cov.getCoverage(result);
+	} else if (subCmd == "save") {
+		if (tokens.size() != 4) throw SyntaxError();
+		try {
+			cov.save(FileOperations::expandTilde(tokens[3].getString()));
+		} catch (FileException& e) {
+			throw CommandException(std::move(e).getMessage());
+		}
+	} else {
+		throw SyntaxError();
+	}
+}
+
 string Debugger::Cmd::help(const vector<string>& tokens) const
 {
 	static const string generalHelp =
@@ -765,6 +1066,9 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"    write             write a byte to a debuggable\n"
 		"    read_block        read a whole block at once\n"
 		"    write_block       write a whole block at once\n"
+		"    read_blocks       read several blocks (or only their changes)\n"
+		"    release_blocks    forget the state of a 'read_blocks -delta' id\n"
+		"    write_blocks      write several blocks at once\n"
 		"    set_bp            insert a new breakpoint\n"
 		"    remove_bp         remove a certain breakpoint\n"
 		"    list_bp           list the active breakpoints\n"
@@ -775,6 +1079,8 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"    remove_condition  remove a certain condition\n"
 		"    list_conditions   list the active conditions\n"
 		"    probe             probe related subcommands\n"
+		"    profile           profile the MSX code\n"
+		"    coverage          record which MSX code gets executed\n"
 		"    cont              continue execution after break\n"
 		"    step              execute one instruction\n"
 		"    break             break CPU at current position\n"
@@ -815,6 +1121,30 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"  The block is specified as size/offset in the debuggable. The "
 		"complete block must fit in the debuggable (see the 'size' "
 		"subcommand).\n";
+	static const string readBlocksHelp =
+		"debug read_blocks [-base64] [-delta <id>] <block> [<block> ...]\n"
+		"  Read several blocks at once, each <block> is a list "
+		"{<name> <addr> <size>}. Returns a list with the contents of "
+		"each block.\n"
+		"  -base64      return the contents base64 encoded instead of as "
+		"Tcl binary strings, this is more compact over the external "
+		"control connection\n"
+		"  -delta <id>  instead of the contents, return for each block a "
+		"list of <offset> <bytes> pairs with only the bytes that changed "
+		"since the previous call with the same <id> (and the same "
+		"blocks). The first call returns everything. Release the id "
+		"with 'debug release_blocks <id>' when done. At most 16 ids are "
+		"remembered, when more are used the least recently used one is "
+		"forgotten.\n";
+	static const string releaseBlocksHelp =
+		"debug release_blocks <id>\n"
+		"  Forget the blocks that were remembered for "
+		"'debug read_blocks -delta <id>'.\n";
+	static const string writeBlocksHelp =
+		"debug write_blocks [-base64] <block> [<block> ...]\n"
+		"  Write several blocks at once, each <block> is a list "
+		"{<name> <addr> <values>}. With -base64 the values are base64 "
+		"encoded, otherwise they must be Tcl binary strings.\n";
 	static const string writeBlockHelp =
 		"debug write_block <name> <addr> <values>\n"
 		"  Write a whole block at once. This is equivalent with repeated "
@@ -913,6 +1243,44 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		"    set_bp <probe> [<cond>] [<cmd>]  set a breakpoint on the given probe\n"
 		"    remove_bp <id>                   remove the given breakpoint\n"
 		"    list_bp                          returns a list of breakpoints that are set on probes\n";
+	static const string profileHelp =
+		"debug profile <subcommand> [<arguments>]\n"
+		"  Profile the code running on the MSX CPU. Possible subcommands are:\n"
+		"    start exact          count the instructions and cycles per address\n"
+		"    start sample [<hz>]  sample the program counter <hz> times per\n"
+		"                         second of emulated time (default 10000)\n"
+		"    stop                 stop profiling, the results are kept\n"
+		"    clear                throw away the results\n"
+		"    status               returns {<mode> <count> <cycles>}\n"
+		"    flat [<n>]           returns {<location> <count> <cycles>} for the\n"
+		"                         busiest <n> (default 100) addresses\n"
+		"    functions [<n>]      returns {<function> <calls> <self-cycles> "
+		"<total-cycles>} (exact mode only)\n"
+		"    calls [<n>]          returns {<caller> <callee> <calls> "
+		"<total-cycles>} (exact mode only)\n"
+		"  Exact mode slows down emulation (like breakpoints), it tracks "
+		"CALL/RST instructions and interrupts to build the call graph. "
+		"Sample mode hardly costs any speed, it has no cycle counts.\n"
+		"  A location is formatted as <ps>[-<ss>][/<segment>]:<address>, "
+		"the (ROM or RAM) mapper segment is only known in sample mode. "
+		"The results are not part of the machine state (e.g. reverse "
+		"doesn't restore them).\n";
+	static const string coverageHelp =
+		"debug coverage <subcommand> [<arguments>]\n"
+		"  Record which instructions get executed. Possible subcommands are:\n"
+		"    start        start recording\n"
+		"    stop         stop recording, the results are kept\n"
+		"    clear        throw away the results\n"
+		"    status       returns {<on|off> <number-of-addresses>}\n"
+		"    list         returns {<device> <block> <ranges>} for each device "
+		"and ROM block (or mapper segment)\n"
+		"    save <file>  save the list in a file, one line per device and "
+		"block\n"
+		"  Addresses are CPU addresses, only the first byte of each "
+		"instruction is marked. Ranges are formatted as <first>-<last> "
+		"(hex), <block> is '-' for devices without ROM blocks or "
+		"segments. Recording slows down emulation (like breakpoints), "
+		"the results are not part of the machine state.\n";
 	static const string contHelp =
 		"debug cont\n"
 		"  Continue execution after CPU was breaked.\n";
@@ -956,6 +1324,12 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		return writeHelp;
 	} else if (tokens[1] == "read_block") {
 		return readBlockHelp;
+	} else if (tokens[1] == "read_blocks") {
+		return readBlocksHelp;
+	} else if (tokens[1] == "release_blocks") {
+		return releaseBlocksHelp;
+	} else if (tokens[1] == "write_blocks") {
+		return writeBlocksHelp;
 	} else if (tokens[1] == "write_block") {
 		return writeBlockHelp;
 	} else if (tokens[1] == "set_bp") {
@@ -978,6 +1352,10 @@ string Debugger::Cmd::help(const vector<string>& tokens) const
 		return listCondHelp;
 	} else if (tokens[1] == "probe") {
 		return probeHelp;
+	} else if (tokens[1] == "profile") {
+		return profileHelp;
+	} else if (tokens[1] == "coverage") {
+		return coverageHelp;
 	} else if (tokens[1] == "cont") {
 		return contHelp;
 	} else if (tokens[1] == "step") {
@@ -1025,7 +1403,8 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 	static const char* const otherCmds[] = {
 		"disasm", "set_bp", "remove_bp", "set_watchpoint",
 		"remove_watchpoint", "set_condition", "remove_condition",
-		"probe",
+		"probe", "profile", "coverage", "read_blocks", "release_blocks",
+		"write_blocks",
 	};
 	switch (tokens.size()) {
 	case 2: {
@@ -1059,6 +1438,18 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 					"remove_bp", "list_bp",
 				};
 				completeString(tokens, subCmds);
+			} else if (tokens[1] == "profile") {
+				static const char* const subCmds[] = {
+					"start", "stop", "clear", "status",
+					"flat", "functions", "calls",
+				};
+				completeString(tokens, subCmds);
+			} else if (tokens[1] == "coverage") {
+				static const char* const subCmds[] = {
+					"start", "stop", "clear", "status",
+					"list", "save",
+				};
+				completeString(tokens, subCmds);
 			}
 		}
 		break;
@@ -1070,6 +1461,11 @@ void Debugger::Cmd::tabCompletion(vector<string>& tokens) const
 				debugger().probes,
 				[](auto* p) { return p->getName(); }));
 			completeString(tokens, probeNames);
+		} else if ((tokens[1] == "profile") && (tokens[2] == "start")) {
+			static const char* const modes[] = { "exact", "sample" };
+			completeString(tokens, modes);
+		} else if ((tokens[1] == "coverage") && (tokens[2] == "save")) {
+			completeFileName(tokens, userFileContext());
 		}
 		break;
 	}
@@ -8,6 +8,7 @@
 #include "string_view.hh"
 #include "outer.hh"
 #include "xxhash.hh"
+#include <string>
 #include <vector>
 #include <memory>
 
@@ -18,6 +19,7 @@ class Debuggable;
 class ProbeBase;
 class ProbeBreakPoint;
 class MSXCPU;
+class Sha1Sum;
 
 class Debugger
 {
@@ -32,6 +34,11 @@ public:
 	void unregisterDebuggable (string_view name, Debuggable& debuggable);
 	Debuggable* findDebuggable(string_view name);
 
+	/** Hash over the content of all debuggables (in order of their name).
+	  * Used to compare the machine state at the end of different emulation
+	  * runs, see 'reverse verifyreplay'. */
+	Sha1Sum getDebuggablesHash();
+
 	void registerProbe  (ProbeBase& probe);
 	void unregisterProbe(ProbeBase& probe);
 	ProbeBase* findProbe(string_view name);
@@ -78,8 +85,11 @@ private:
 		void size(span<const TclObject> tokens, TclObject& result);
 		void read(span<const TclObject> tokens, TclObject& result);
 		void readBlock(span<const TclObject> tokens, TclObject& result);
+		void readBlocks(span<const TclObject> tokens, TclObject& result);
+		void releaseBlocks(span<const TclObject> tokens, TclObject& result);
 		void write(span<const TclObject> tokens, TclObject& result);
 		void writeBlock(span<const TclObject> tokens, TclObject& result);
+		void writeBlocks(span<const TclObject> tokens, TclObject& result);
 		void setBreakPoint(span<const TclObject> tokens, TclObject& result);
 		void removeBreakPoint(span<const TclObject> tokens, TclObject& result);
 		void listBreakPoints(span<const TclObject> tokens, TclObject& result);
@@ -99,6 +109,8 @@ private:
 		void probeSetBreakPoint(span<const TclObject> tokens, TclObject& result);
 		void probeRemoveBreakPoint(span<const TclObject> tokens, TclObject& result);
 		void probeListBreakPoints(span<const TclObject> tokens, TclObject& result);
+		void profile(span<const TclObject> tokens, TclObject& result, EmuTime::param time);
+		void coverage(span<const TclObject> tokens, TclObject& result);
 	} cmd;
 
 	struct NameFromProbe {
@@ -111,6 +123,24 @@ private:
 	hash_set<ProbeBase*, NameFromProbe, XXHasher>  probes;
 	using ProbeBreakPoints = std::vector<std::unique_ptr<ProbeBreakPoint>>;
 	ProbeBreakPoints probeBreakPoints; // unordered
+
+	// The blocks returned by the last 'debug read_blocks -delta <id>',
+	// per id. Ordered from least to most recently used. At most
+	// MAX_DELTA_IDS ids are kept, when a client forgets to release its
+	// id, the oldest one is dropped (a later call with that id then
+	// simply returns everything again).
+	struct BlockSnapshot {
+		std::string name;
+		unsigned address;
+		std::vector<byte> data;
+	};
+	struct DeltaSnapshots {
+		std::string id;
+		std::vector<BlockSnapshot> blocks;
+	};
+	static const size_t MAX_DELTA_IDS = 16;
+	std::vector<BlockSnapshot>& getDeltaSnapshots(const std::string& id);
+	std::vector<DeltaSnapshots> deltaSnapshots;
 	MSXCPU* cpu;
 };
 
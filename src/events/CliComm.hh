@@ -28,6 +28,7 @@ public:
 		EXTENSION,
 		SOUNDDEVICE,
 		CONNECTOR,
+		FRAMEHASH,
 		NUM_UPDATES // must be last
 	};
 
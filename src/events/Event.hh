@@ -68,6 +68,9 @@ enum EventType
 	OPENMSX_MIDI_IN_COREMIDI_VIRTUAL_EVENT,
 	OPENMSX_RS232_TESTER_EVENT,
 
+	/** Send by the background PNG writer when a screenshot is written. */
+	OPENMSX_SCREENSHOT_WRITTEN_EVENT,
+
 	NUM_EVENT_TYPES // must be last
 };
 
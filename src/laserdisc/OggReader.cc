@@ -6,6 +6,7 @@
 #include "MemoryOps.hh"
 #include "ranges.hh"
 #include "stl.hh"
+#include "strCat.hh"
 #include "stringsp.hh" // for strncasecmp
 #include "view.hh"
 #include <cstring> // for memcpy, memcmp
@@ -55,6 +56,11 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 	currentSample = 0;
 	currentFrame = 1;
 	vorbisPos = 0;
+	indexedFileSize = size_t(-1);
+	prefetchEnabled = false;
+	prefetching = false;
+	atEnd = false;
+	stopDecoder = false;
 
 	th_info ti;
 	th_comment tc;
@@ -201,6 +207,8 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 	th_setup_free(tsi);
 	th_info_clear(&ti);
 	th_comment_clear(&tc);
+
+	decoder = std::thread([this] { decoderLoop(); });
 }
 
 void OggReader::cleanup()
@@ -227,9 +235,59 @@ void OggReader::cleanup()
 
 OggReader::~OggReader()
 {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopDecoder = true;
+	}
+	decoderCond.notify_one();
+	decoder.join();
 	cleanup();
 }
 
+// Don't decode too far ahead: the frames are big, and the consumer only
+// looks at the first few frames in the list (see getFrameNo()).
+static const size_t PREFETCH_FRAMES = 8;
+static const size_t PREFETCH_AUDIO = 64; // fragments
+
+bool OggReader::needPrefetch() const
+{
+	return prefetchEnabled && !atEnd && (state == PLAYING) &&
+	       (frameList.size() < std::min(PREFETCH_FRAMES,
+	                                    size_t(1) << granuleShift)) &&
+	       (audioList.size() < PREFETCH_AUDIO);
+}
+
+void OggReader::decoderLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		decoderCond.wait(lock, [&] { return stopDecoder || needPrefetch(); });
+		if (stopDecoder) return;
+		prefetching = true;
+		if (!nextPacket()) atEnd = true;
+		prefetching = false;
+	}
+}
+
+template<typename... Args> void OggReader::warning(Args&& ...args)
+{
+	if (prefetching) {
+		// CliComm may only be used from the main thread, report it
+		// on the next call from the main thread.
+		warnings.push_back(strCat(std::forward<Args>(args)...));
+	} else {
+		cli.printWarning(std::forward<Args>(args)...);
+	}
+}
+
+void OggReader::flushWarnings()
+{
+	for (auto& w : warnings) {
+		cli.printWarning(w);
+	}
+	warnings.clear();
+}
+
 /** Vorbis only records the ogg position (in no. of samples) once per ogg
  * page. After seeking we have already decoded some audio before we encounter
  * the exact position we are at. Fixup the positions and discard any unwanted
@@ -245,7 +303,7 @@ void OggReader::vorbisFoundPosition()
 
 	// last is now the first vorbis audio decoded
 	if (last > currentSample) {
-		cli.printWarning("missing part of audio stream");
+		warning("missing part of audio stream");
 	}
 
 	if (vorbisPos > currentSample) {
@@ -408,7 +466,7 @@ void OggReader::readVorbis(ogg_packet* packet)
 			vorbisFoundPosition();
 		} else {
 			if (vorbisPos != size_t(packet->granulepos)) {
-				cli.printWarning(
+				warning(
                                         "vorbis audio out of sync, expected ",
 					vorbisPos, ", got ", packet->granulepos);
 				vorbisPos = packet->granulepos;
@@ -529,25 +587,25 @@ void OggReader::readTheora(ogg_packet* packet)
 	switch (rc) {
 	case TH_DUPFRAME:
 		if (frameList.empty()) {
-			cli.printWarning("Theora error: dup frame encountered "
-					 "without preceding frame");
+			warning("Theora error: dup frame encountered "
+			        "without preceding frame");
 		} else {
 			frameList.back()->length++;
 		}
 		break;
 	case TH_EIMPL:
-		cli.printWarning("Theora error: not capable of reading this");
+		warning("Theora error: not capable of reading this");
 		break;
 	case TH_EFAULT:
-		cli.printWarning("Theora error: API not used correctly");
+		warning("Theora error: API not used correctly");
 		break;
 	case TH_EBADPACKET:
-		cli.printWarning("Theora error: bad packet");
+		warning("Theora error: bad packet");
 		break;
 	case 0:
 		break;
 	default:
-		cli.printWarning("Theora error: unknown error ", rc);
+		warning("Theora error: unknown error ", rc);
 		break;
 	}
 
@@ -588,7 +646,7 @@ void OggReader::readTheora(ogg_packet* packet)
 	if (last && (last->no != size_t(-1))) {
 		if ((frameno != size_t(-1)) &&
 		    (frameno != last->no + last->length)) {
-			cli.printWarning("Theora frame sequence wrong");
+			warning("Theora frame sequence wrong");
 		} else {
 			frameno = last->no + last->length;
 		}
@@ -613,6 +671,8 @@ void OggReader::readTheora(ogg_packet* packet)
 
 void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 {
+	std::unique_lock<std::mutex> lock(mutex);
+	flushWarnings();
 	Frame* frame;
 	while (true) {
 		// If there are no frames or the frames we have read
@@ -669,6 +729,10 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		}
 	}
 
+	// Only this thread removes frames from frameList, so 'frame' stays
+	// valid while the decoder thread continues.
+	lock.unlock();
+	decoderCond.notify_one();
 	yuv2rgb::convert(frame->buffer, rawFrame);
 }
 
@@ -680,6 +744,11 @@ void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
 
 const AudioFragment* OggReader::getAudio(size_t sample)
 {
+	std::lock_guard<std::mutex> lock(mutex);
+	flushWarnings();
+	// The decoder thread continues once we release the lock.
+	decoderCond.notify_one();
+
 	// Read while position is unknown
 	while (audioList.empty() ||
 	       audioList.front()->position == AudioFragment::UNKNOWN_POS) {
@@ -752,15 +821,15 @@ bool OggReader::nextPacket()
 		int serial = ogg_page_serialno(&page);
 		if (serial == audioSerial) {
 			if (ogg_stream_pagein(&vorbisStream, &page)) {
-				cli.printWarning("Failed to submit vorbis page");
+				warning("Failed to submit vorbis page");
 			}
 		} else if (serial == videoSerial) {
 			if (ogg_stream_pagein(&theoraStream, &page)) {
-				cli.printWarning("Failed to submit theora page");
+				warning("Failed to submit theora page");
 			}
 		} else if (serial != skeletonSerial) {
-			cli.printWarning("Unexpected stream with serial ",
-			                 serial, " in ogg file");
+			warning("Unexpected stream with serial ",
+			        serial, " in ogg file");
 		}
 	}
 }
@@ -790,16 +859,25 @@ bool OggReader::nextPage(ogg_page* page)
 		fileOffset += chunk;
 
 		if (ogg_sync_wrote(&sync, long(chunk)) == -1) {
-			cli.printWarning("Internal error: ogg_sync_wrote failed");
+			warning("Internal error: ogg_sync_wrote failed");
 		}
 	}
 
 	return true;
 }
 
-size_t OggReader::bisection(
-	size_t frame, size_t sample,
-	size_t maxOffset, size_t maxSamples, size_t maxFrames)
+void OggReader::addSeekPoint(size_t offset, size_t frame, size_t sample)
+{
+	if ((frame == size_t(-1)) || (sample == AudioFragment::UNKNOWN_POS)) {
+		return;
+	}
+	auto it = ranges::lower_bound(seekPoints, offset,
+		[](const SeekPoint& p, size_t o) { return p.offset < o; });
+	if ((it != end(seekPoints)) && (it->offset == offset)) return;
+	seekPoints.insert(it, SeekPoint{offset, frame, sample});
+}
+
+size_t OggReader::bisection(size_t frame, size_t sample)
 {
 	// Defined to be a power-of-two such that the arthmetic can be done faster.
 	// Note that the sample-number is in the range of: 1..(44100*60*60)
@@ -807,9 +885,30 @@ size_t OggReader::bisection(
 
 	uint64_t offsetA = 0, offsetB = maxOffset;
 	uint64_t sampleA = 0, sampleB = maxSamples;
-	uint64_t frameA = 1, frameB = maxFrames;
+	uint64_t frameA = 1, frameB = totalFrames;
+
+	// Start from the smallest interval we already know from previous
+	// seeks. This often finds the offset without reading the file.
+	for (auto& p : seekPoints) {
+		if (p.sample > sample || p.frame > frame) {
+			offsetB = p.offset;
+			sampleB = p.sample;
+			frameB = p.frame;
+			break;
+		} else if (p.sample + getSampleRate() < sample &&
+				p.frame + 64 < frame) {
+			offsetA = p.offset;
+			sampleA = p.sample;
+			frameA = p.frame;
+		} else {
+			return p.offset;
+		}
+	}
 
 	while (true) {
+		if ((frameB <= frameA) || (sampleB <= sampleA)) {
+			return offsetA;
+		}
 		uint64_t ratio = (frame - frameA) * SHIFT / (frameB - frameA);
 		if (ratio < 5) {
 			return offsetA;
@@ -837,6 +936,7 @@ size_t OggReader::bisection(
 		}
 
 		state = PLAYING;
+		addSeekPoint(offset, currentFrame, currentSample);
 
 		if (currentSample > sample || currentFrame > frame) {
 			offsetB = offset;
@@ -853,16 +953,11 @@ size_t OggReader::bisection(
 	}
 }
 
-size_t OggReader::findOffset(size_t frame, size_t sample)
+void OggReader::findEnd()
 {
 	static const size_t STEP = 32 * 1024;
 
-	// first calculate total length in bytes, samples and frames
-
-	// The file might have changed since we last requested its size,
-	// we assume that only data will be added to it and the ogg streams
-	// are exactly as before
-	fileSize = file.getSize();
+	// Calculate total length in bytes, samples and frames.
 	auto offset = fileSize - 1;
 
 	while (offset > 0) {
@@ -892,6 +987,22 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 	}
 
 	totalFrames = currentFrame;
+	maxOffset = offset;
+	maxSamples = currentSample;
+}
+
+size_t OggReader::findOffset(size_t frame, size_t sample)
+{
+	// The file might have changed since we last requested its size,
+	// we assume that only data will be added to it and the ogg streams
+	// are exactly as before. So the seek points stay valid, but the
+	// length of the streams and the previous seek results do not.
+	fileSize = file.getSize();
+	if (fileSize != indexedFileSize) {
+		findEnd();
+		indexedFileSize = fileSize;
+		seekCache.clear();
+	}
 
 	// If we're close to beginning, don't bother searching for it,
 	// just start at the beginning (arbitrary boundary of 1 second).
@@ -900,16 +1011,21 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 		return 0;
 	}
 
-	auto maxOffset = offset;
-	auto maxSamples = currentSample;
-	auto maxFrames = currentFrame;
+	// Seeking to the same position again (e.g. a chapter start) is
+	// common. Then we know the offset and key frame already.
+	auto requested = std::make_pair(frame, sample);
+	auto cached = seekCache.find(requested);
+	if (cached != end(seekCache)) {
+		keyFrame = cached->second.keyFrame;
+		return cached->second.offset;
+	}
 
-	if ((sample > maxSamples) || (frame > maxFrames)) {
+	if ((sample > maxSamples) || (frame > totalFrames)) {
 		sample = maxSamples;
-		frame = maxFrames;
+		frame = totalFrames;
 	}
 
-	offset = bisection(frame, sample, maxOffset, maxSamples, maxFrames);
+	auto offset = bisection(frame, sample);
 
 	// Find key frame
 	file.seek(offset);
@@ -926,15 +1042,19 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 
 	state = PLAYING;
 
-	if ((keyFrame == size_t(-1)) || (frame == keyFrame)) {
-		return offset;
+	if ((keyFrame != size_t(-1)) && (frame != keyFrame)) {
+		offset = bisection(keyFrame, sample);
 	}
 
-	return bisection(keyFrame, sample, maxOffset, maxSamples, maxFrames);
+	seekCache[requested] = SeekResult{offset, keyFrame};
+	return offset;
 }
 
 bool OggReader::seek(size_t frame, size_t samples)
 {
+	std::unique_lock<std::mutex> lock(mutex);
+	flushWarnings();
+
 	// Remove all queued frames
 	recycleFrameList.insert(end(recycleFrameList),
 		make_move_iterator(begin(frameList)),
@@ -961,6 +1081,10 @@ bool OggReader::seek(size_t frame, size_t samples)
 
 	vorbis_synthesis_restart(&vd);
 
+	atEnd = false;
+	prefetchEnabled = true;
+	lock.unlock();
+	decoderCond.notify_one();
 	return true;
 }
 
@@ -6,8 +6,13 @@
 #include <ogg/ogg.h>
 #include <vorbis/codec.h>
 #include <theora/theoradec.h>
+#include <condition_variable>
 #include <memory>
 #include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -70,9 +75,15 @@ private:
 	void vorbisFoundPosition();
 	size_t frameNo(ogg_packet* packet);
 
+	template<typename... Args> void warning(Args&& ...args);
+	void flushWarnings();
+	bool needPrefetch() const;
+	void decoderLoop();
+
+	void findEnd();
 	size_t findOffset(size_t frame, size_t sample);
-	size_t bisection(size_t frame, size_t sample,
-	                 size_t maxOffset, size_t maxSamples, size_t maxFrames);
+	size_t bisection(size_t frame, size_t sample);
+	void addSeekPoint(size_t offset, size_t frame, size_t sample);
 
 	CliComm& cli;
 	File file;
@@ -116,9 +127,37 @@ private:
 	std::list<std::unique_ptr<AudioFragment>> audioList;
 	cb_queue<std::unique_ptr<AudioFragment>> recycleAudioList;
 
+	// seek index
+	struct SeekPoint {
+		size_t offset; // the first frame and sample found after
+		size_t frame;  // this file offset
+		size_t sample;
+	};
+	struct SeekResult {
+		size_t offset;
+		size_t keyFrame;
+	};
+	size_t indexedFileSize; // file size for which the below is valid
+	size_t maxOffset;
+	size_t maxSamples;
+	std::vector<SeekPoint> seekPoints; // sorted on offset
+	std::map<std::pair<size_t, size_t>, SeekResult> seekCache;
+
 	// Metadata
 	std::vector<size_t> stopFrames;
 	std::vector<std::pair<int, size_t>> chapters;
+
+	// Decoder thread, it decodes packets ahead of playback so that
+	// getFrameNo() and getAudio() (usually) find their data already
+	// decoded. All above state is protected by 'mutex'.
+	std::mutex mutex;
+	std::condition_variable decoderCond;
+	std::thread decoder;
+	std::vector<std::string> warnings;
+	bool prefetchEnabled; // only after the first seek()
+	bool prefetching;     // decoder thread is decoding a packet
+	bool atEnd;
+	bool stopDecoder;
 };
 
 } // namespace openmsx
@@ -56,6 +56,26 @@ byte* CheckedRam::getWriteCacheLine(unsigned addr) const
 	     ? const_cast<byte*>(&ram[addr]) : nullptr;
 }
 
+bool CheckedRam::isPageInitialized(unsigned addr) const
+{
+	if ((addr + CacheLine::PAGE_SIZE) > getSize()) return false;
+	unsigned first = addr >> CacheLine::BITS;
+	for (unsigned i = 0; i < CacheLine::PAGE_NUM; ++i) {
+		if (!completely_initialized_cacheline[first + i]) return false;
+	}
+	return true;
+}
+
+const byte* CheckedRam::getReadCachePage(unsigned addr) const
+{
+	return isPageInitialized(addr) ? &ram[addr] : nullptr;
+}
+
+byte* CheckedRam::getWriteCachePage(unsigned addr) const
+{
+	return isPageInitialized(addr) ? const_cast<byte*>(&ram[addr]) : nullptr;
+}
+
 void CheckedRam::write(unsigned addr, const byte value)
 {
 	unsigned line = addr >> CacheLine::BITS;
@@ -37,6 +37,8 @@ public:
 
 	const byte* getReadCacheLine(unsigned addr) const;
 	byte* getWriteCacheLine(unsigned addr) const;
+	const byte* getReadCachePage(unsigned addr) const;
+	byte* getWriteCachePage(unsigned addr) const;
 
 	unsigned getSize() const { return ram.getSize(); }
 	void clear();
@@ -55,6 +57,7 @@ public:
 
 private:
 	void init();
+	bool isPageInitialized(unsigned addr) const;
 
 	// Observer<Setting>
 	void update(const Setting& setting) override;
@@ -94,6 +94,17 @@ byte* MSXMemoryMapper::getWriteCacheLine(word start) const
 	return checkedRam.getWriteCacheLine(calcAddress(start));
 }
 
+// A segment is always a complete, contiguous 16kB block.
+const byte* MSXMemoryMapper::getReadCachePage(word start) const
+{
+	return checkedRam.getReadCachePage(calcAddress(start));
+}
+
+byte* MSXMemoryMapper::getWriteCachePage(word start) const
+{
+	return checkedRam.getWriteCachePage(calcAddress(start));
+}
+
 
 // SimpleDebuggable
 
@@ -31,6 +31,8 @@ public:
 	void writeMem(word address, byte value, EmuTime::param time) override;
 	const byte* getReadCacheLine(word start) const override;
 	byte* getWriteCacheLine(word start) const override;
+	const byte* getReadCachePage(word start) const override;
+	byte* getWriteCachePage(word start) const override;
 	byte peekMem(word address, EmuTime::param time) const override;
 
 	template<typename Archive>
@@ -1,6 +1,7 @@
 #include "MSXRam.hh"
 #include "CheckedRam.hh"
 #include "Ram.hh" // because we serialize Ram instead of CheckedRam
+#include "CacheLine.hh"
 #include "XMLElement.hh"
 #include "serialize.hh"
 #include <cassert>
@@ -70,6 +71,25 @@ byte* MSXRam::getWriteCacheLine(word start) const
 	return checkedRam->getWriteCacheLine(translate(start));
 }
 
+bool MSXRam::isContiguousPage(word start) const
+{
+	// false when the page (partly) mirrors the RAM
+	unsigned last = start + CacheLine::PAGE_SIZE - 1;
+	return translate(last) == (translate(start) + CacheLine::PAGE_SIZE - 1);
+}
+
+const byte* MSXRam::getReadCachePage(word start) const
+{
+	return isContiguousPage(start)
+	     ? checkedRam->getReadCachePage(translate(start)) : nullptr;
+}
+
+byte* MSXRam::getWriteCachePage(word start) const
+{
+	return isContiguousPage(start)
+	     ? checkedRam->getWriteCachePage(translate(start)) : nullptr;
+}
+
 template<typename Archive>
 void MSXRam::serialize(Archive& ar, unsigned /*version*/)
 {
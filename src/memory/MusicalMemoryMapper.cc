@@ -206,6 +206,18 @@ byte* MusicalMemoryMapper::getWriteCacheLine(word start) const
 	}
 }
 
+// Depending on the control register, parts of a page are registers or are
+// write protected. Keep it simple and only cache per line.
+const byte* MusicalMemoryMapper::getReadCachePage(word /*start*/) const
+{
+	return nullptr;
+}
+
+byte* MusicalMemoryMapper::getWriteCachePage(word /*start*/) const
+{
+	return nullptr;
+}
+
 template<typename Archive>
 void MusicalMemoryMapper::serialize(Archive& ar, unsigned /*version*/)
 {
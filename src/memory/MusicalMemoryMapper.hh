@@ -27,6 +27,8 @@ public:
 	void writeMem(word address, byte value, EmuTime::param time) override;
 	const byte* getReadCacheLine(word start) const override;
 	byte* getWriteCacheLine(word start) const override;
+	const byte* getReadCachePage(word start) const override;
+	byte* getWriteCachePage(word start) const override;
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
@@ -30,6 +30,12 @@ byte* PanasonicRam::getWriteCacheLine(word start) const
 	}
 }
 
+byte* PanasonicRam::getWriteCachePage(word /*start*/) const
+{
+	// write protection is checked per cache line
+	return nullptr;
+}
+
 template<typename Archive>
 void PanasonicRam::serialize(Archive& ar, unsigned /*version*/)
 {
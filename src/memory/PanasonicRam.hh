@@ -14,6 +14,7 @@ public:
 
 	void writeMem(word address, byte value, EmuTime::param time) override;
 	byte* getWriteCacheLine(word start) const override;
+	byte* getWriteCachePage(word start) const override;
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
@@ -48,6 +48,7 @@ RomBlocks<BANK_SIZE>::RomBlocks(
 	// Default mask: wraps at end of ROM image.
 	blockMask = nrBlocks - 1;
 	for (unsigned i = 0; i < NUM_BANKS; i++) {
+		bankPtr[i] = nullptr; // force setBank() to act
 		setRom(i, 0);
 	}
 }
@@ -82,6 +83,12 @@ void RomBlocks<BANK_SIZE>::setBank(byte region, const byte* adr, int block)
 	        (sram && (&(*sram)[0] <= adr) &&
 	                       (adr <= &(*sram)[sram->getSize() - 1])) ||
 	        ((extraMem <= adr) && (adr <= &extraMem[extraSize - 1]))));
+	if ((bankPtr[region] == adr) && (blockNr[region] == byte(block))) {
+		// Many games rewrite the same bank register over and over (e.g.
+		// from their interrupt handler). Nothing changes in that case,
+		// so the CPU cache lines for this region are still valid.
+		return;
+	}
 	bankPtr[region] = adr;
 	blockNr[region] = block; // only for debuggable
 	invalidateMemCache(region * BANK_SIZE, BANK_SIZE);
@@ -98,8 +98,11 @@ void RomKonamiSCC::writeMem(word address, byte value, EmuTime::param time)
 	}
 	if ((address & 0xF800) == 0x9000) {
 		// SCC enable/disable
-		sccEnabled = ((value & 0x3F) == 0x3F);
-		invalidateMemCache(0x9800, 0x0800);
+		bool newSccEnabled = (value & 0x3F) == 0x3F;
+		if (newSccEnabled != sccEnabled) {
+			sccEnabled = newSccEnabled;
+			invalidateMemCache(0x9800, 0x0800);
+		}
 	}
 	if ((address & 0x1800) == 0x1000) {
 		// page selection
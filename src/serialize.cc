@@ -182,10 +182,16 @@ MemBuffer<byte> MemOutputArchive::releaseBuffer(size_t& size)
 
 ////
 
+void MemInputArchive::truncated()
+{
+	throw MSXException("Unexpected end of serialized data");
+}
+
 void MemInputArchive::load(std::string& s)
 {
 	size_t length;
 	load(length);
+	check(length);
 	s.resize(length);
 	if (length) {
 		get(&s[0], length);
@@ -196,6 +202,7 @@ string_view MemInputArchive::loadStr()
 {
 	size_t length;
 	load(length);
+	check(length);
 	const byte* p = buffer.getCurrentPos();
 	buffer.skip(length);
 	return string_view(reinterpret_cast<const char*>(p), length);
@@ -213,13 +220,13 @@ void MemOutputArchive::serialize_blob(const char* /*tag*/, const void* data,
                                       size_t len, bool diff)
 {
 	// Delta-compress in-memory blobs, see DeltaBlock.hh for more details.
-	if (len > SMALL_SIZE) {
-		auto deltaBlockIdx = unsigned(deltaBlocks.size());
+	if (deltaBlocks && (len > SMALL_SIZE)) {
+		auto deltaBlockIdx = unsigned(deltaBlocks->size());
 		save(deltaBlockIdx); // see comment below in MemInputArchive
-		deltaBlocks.push_back(diff
-			? lastDeltaBlocks.createNew(
+		deltaBlocks->push_back(diff
+			? lastDeltaBlocks->createNew(
 				data, static_cast<const uint8_t*>(data), len)
-			: lastDeltaBlocks.createNullDiff(
+			: lastDeltaBlocks->createNullDiff(
 				data, static_cast<const uint8_t*>(data), len));
 	} else {
 		byte* buf = buffer.allocate(len);
@@ -231,7 +238,7 @@ void MemOutputArchive::serialize_blob(const char* /*tag*/, const void* data,
 void MemInputArchive::serialize_blob(const char* /*tag*/, void* data,
                                      size_t len, bool /*diff*/)
 {
-	if (len > SMALL_SIZE) {
+	if (deltaBlocks && (len > SMALL_SIZE)) {
 		// Usually blobs are saved in the same order as they are loaded
 		// (via the serialize_blob() methods in respectively
 		// MemOutputArchive and MemInputArchive). In that case keeping
@@ -241,8 +248,9 @@ void MemInputArchive::serialize_blob(const char* /*tag*/, void* data,
 		// is possible that certain blobs are stored in the savestate,
 		// but skipped while loading. That's why we do need the index.
 		unsigned deltaBlockIdx; load(deltaBlockIdx);
-		deltaBlocks[deltaBlockIdx]->apply(static_cast<uint8_t*>(data), len);
+		(*deltaBlocks)[deltaBlockIdx]->apply(static_cast<uint8_t*>(data), len);
 	} else {
+		check(len);
 		memcpy(data, buffer.getCurrentPos(), len);
 		buffer.skip(len);
 	}
@@ -258,6 +258,15 @@ public:
 		UNREACHABLE; return 0;
 	}
 
+	/** Check the (explicitly stored) size of a collection before space
+	 * for it gets allocated. Only archives that read untrusted data need
+	 * to do something here.
+	 */
+	void checkCollectionSize(int /*n*/) const
+	{
+		// nothing
+	}
+
 	/** Indicate begin of a tag.
 	 * Only XML archives use this, other archives ignore it.
 	 * XML saver uses it as a name for the current tag, it doesn't
@@ -599,12 +608,21 @@ public:
 	MemOutputArchive(LastDeltaBlocks& lastDeltaBlocks_,
 	                 std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks_,
 			 bool reverseSnapshot_)
-		: lastDeltaBlocks(lastDeltaBlocks_)
-		, deltaBlocks(deltaBlocks_)
+		: lastDeltaBlocks(&lastDeltaBlocks_)
+		, deltaBlocks(&deltaBlocks_)
 		, reverseSnapshot(reverseSnapshot_)
 	{
 	}
 
+	/** Without delta blocks: all blobs are stored in the buffer itself,
+	  * so that it can e.g. be written to a file. */
+	MemOutputArchive()
+		: lastDeltaBlocks(nullptr)
+		, deltaBlocks(nullptr)
+		, reverseSnapshot(false)
+	{
+	}
+
 	~MemOutputArchive()
 	{
 		assert(openSections.empty());
@@ -655,8 +673,8 @@ private:
 
 	OutputBuffer buffer;
 	std::vector<size_t> openSections;
-	LastDeltaBlocks& lastDeltaBlocks;
-	std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks;
+	LastDeltaBlocks* lastDeltaBlocks;
+	std::vector<std::shared_ptr<DeltaBlock>>* deltaBlocks;
 	const bool reverseSnapshot;
 };
 
@@ -666,7 +684,16 @@ public:
 	MemInputArchive(const byte* data, size_t size,
 	                const std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks_)
 		: buffer(data, size)
-		, deltaBlocks(deltaBlocks_)
+		, deltaBlocks(&deltaBlocks_)
+	{
+	}
+
+	/** Counterpart of MemOutputArchive without delta blocks. The data
+	  * may come from a file, so in this mode reading past the end of the
+	  * data throws an MSXException. */
+	MemInputArchive(const byte* data, size_t size)
+		: buffer(data, size)
+		, deltaBlocks(nullptr)
 	{
 	}
 
@@ -693,11 +720,22 @@ public:
 	void serialize_blob(const char* tag, void* data, size_t len,
 	                    bool diff = true);
 
+	// Every element takes at least one byte, so a size that's larger
+	// than the remaining data is corrupt.
+	void checkCollectionSize(int n) const
+	{
+		if (!deltaBlocks &&
+		    ((n < 0) || (size_t(n) > buffer.getRemaining()))) {
+			truncated();
+		}
+	}
+
 	void skipSection(bool skip)
 	{
 		size_t num;
 		load(num);
 		if (skip) {
+			check(num);
 			buffer.skip(num);
 		}
 	}
@@ -706,12 +744,23 @@ private:
 	void get(void* data, size_t len)
 	{
 		if (len) {
+			check(len);
 			buffer.read(data, len);
 		}
 	}
 
+	// With delta blocks the data was created by this process, so it's
+	// only checked in the other mode.
+	void check(size_t len) const
+	{
+		if (!deltaBlocks && (len > buffer.getRemaining())) {
+			truncated();
+		}
+	}
+	static void truncated(); // does not return (throws)
+
 	InputBuffer buffer;
-	const std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks;
+	const std::vector<std::shared_ptr<DeltaBlock>>* deltaBlocks;
 };
 
 ////
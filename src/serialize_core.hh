@@ -671,6 +671,7 @@ template<typename TC> struct CollectionLoader
 				n = ar.countChildren();
 			} else {
 				ar.serialize("size", n);
+				ar.checkCollectionSize(n);
 			}
 		}
 		sac::prepare(tc, n);
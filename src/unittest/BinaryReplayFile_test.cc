@@ -0,0 +1,266 @@
+#include "catch.hpp"
+#include "BinaryReplayFile.hh"
+#include "EmuTime.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "MSXException.hh"
+#include "serialize.hh"
+#include "serialize_stl.hh"
+#include "xxhash.hh"
+#include <zlib.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+
+static std::string tempFile()
+{
+	return FileOperations::join(FileOperations::getTempDir(),
+	                            "openmsx-binary-replay-test.omr");
+}
+
+static std::vector<byte> readAll(const std::string& filename)
+{
+	File file(filename, "rb");
+	std::vector<byte> result(file.getSize());
+	if (!result.empty()) file.read(result.data(), result.size());
+	return result;
+}
+
+static void writeAll(const std::string& filename, const byte* data, size_t size)
+{
+	File file(filename, File::TRUNCATE);
+	if (size) file.write(data, size);
+}
+
+struct Chunk {
+	uint32_t type;
+	std::vector<byte> data;
+};
+
+// Read all chunks, throws on corrupt input.
+static std::vector<Chunk> readChunks(const std::string& filename,
+                                     std::string& compatibility)
+{
+	File file(filename, "rb");
+	if (!BinaryReplayFile::readHeader(file, compatibility)) {
+		throw MSXException("no binary replay");
+	}
+	std::vector<Chunk> result;
+	uint32_t type;
+	MemBuffer<byte> data;
+	size_t size;
+	while (BinaryReplayFile::readChunk(file, type, data, size)) {
+		result.push_back({type, std::vector<byte>(data.data(), data.data() + size)});
+	}
+	return result;
+}
+
+static std::vector<Chunk> testChunks()
+{
+	std::vector<Chunk> result;
+	result.push_back({1, std::vector<byte>(100000, 0x55)}); // compressible
+	std::vector<byte> noise(5000);
+	for (size_t i = 0; i < noise.size(); ++i) noise[i] = byte(i * 2654435761u >> 13);
+	result.push_back({2, noise});
+	result.push_back({3, std::vector<byte>(1, 42)});
+	return result;
+}
+
+static std::vector<byte> validFile()
+{
+	auto filename = tempFile();
+	{
+		File file(filename, File::TRUNCATE);
+		BinaryReplayFile::writeHeader(file, "test 1.0");
+		for (auto& c : testChunks()) {
+			BinaryReplayFile::writeChunk(file, c.type, c.data.data(), c.data.size());
+		}
+	}
+	return readAll(filename);
+}
+
+// Write a chunk header with the given values and a matching hash.
+static void writeRawChunk(const std::string& filename, uint32_t size,
+                          const std::vector<byte>& compressed)
+{
+	File file(filename, File::TRUNCATE);
+	BinaryReplayFile::writeHeader(file, "test 1.0");
+	uint32_t header[4] = {
+		1, size, uint32_t(compressed.size()),
+		xxhash(string_view(reinterpret_cast<const char*>(compressed.data()),
+		                   compressed.size()))
+	};
+	file.write(header, sizeof(header));
+	file.write(compressed.data(), compressed.size());
+}
+
+static std::vector<byte> compress(const std::vector<byte>& data)
+{
+	auto len = uLongf(compressBound(uLong(data.size())));
+	std::vector<byte> result(len);
+	REQUIRE(compress2(result.data(), &len, data.data(), uLong(data.size()), 1) == Z_OK);
+	result.resize(len);
+	return result;
+}
+
+TEST_CASE("BinaryReplayFile: round trip")
+{
+	auto filename = tempFile();
+	auto bytes = validFile();
+	std::string compatibility;
+	auto chunks = readChunks(filename, compatibility);
+	CHECK(compatibility == "test 1.0");
+	auto expected = testChunks();
+	REQUIRE(chunks.size() == expected.size());
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		CHECK(chunks[i].type == expected[i].type);
+		CHECK(chunks[i].data == expected[i].data);
+	}
+
+	// not a binary replay
+	const char xml[] = "<?xml version=\"1.0\" ?>";
+	writeAll(filename, reinterpret_cast<const byte*>(xml), sizeof(xml) - 1);
+	File file(filename, "rb");
+	CHECK(!BinaryReplayFile::readHeader(file, compatibility));
+}
+
+TEST_CASE("BinaryReplayFile: truncated file")
+{
+	auto filename = tempFile();
+	auto bytes = validFile();
+	std::string compatibility;
+	// Every prefix either throws, or (when cut between two chunks) returns
+	// fewer chunks.
+	for (size_t len = 0; len < bytes.size(); len += 7) {
+		writeAll(filename, bytes.data(), len);
+		try {
+			auto chunks = readChunks(filename, compatibility);
+			CHECK(chunks.size() < testChunks().size());
+		} catch (MSXException&) {
+			// ok
+		}
+	}
+}
+
+TEST_CASE("BinaryReplayFile: corrupt file")
+{
+	auto filename = tempFile();
+	auto bytes = validFile();
+	auto headerSize = 22 + 1 + 8; // magic, length, "test 1.0"
+	std::string compatibility;
+	// Flip one bit in the size, compressed size, hash or data of the first
+	// chunk (the type is checked by the caller).
+	uint32_t compressedSize;
+	memcpy(&compressedSize, &bytes[headerSize + 8], sizeof(compressedSize));
+	auto end = headerSize + 16 + compressedSize;
+	for (size_t pos = headerSize + 4; pos < end; ++pos) {
+		auto copy = bytes;
+		copy[pos] ^= 0x10;
+		writeAll(filename, copy.data(), copy.size());
+		std::vector<Chunk> chunks;
+		try {
+			chunks = readChunks(filename, compatibility);
+		} catch (MSXException&) {
+			continue; // ok
+		}
+		FAIL("corruption at offset " << pos << " not detected");
+	}
+}
+
+TEST_CASE("BinaryReplayFile: crafted chunks")
+{
+	auto filename = tempFile();
+	std::string compatibility;
+	std::vector<byte> data(1000, 0x33);
+	auto compressed = compress(data);
+
+	// correct
+	writeRawChunk(filename, 1000, compressed);
+	CHECK(readChunks(filename, compatibility).size() == 1);
+
+	// size in the header too small or too large (with a matching hash)
+	writeRawChunk(filename, 999, compressed);
+	CHECK_THROWS_AS(readChunks(filename, compatibility), MSXException);
+	writeRawChunk(filename, 1001, compressed);
+	CHECK_THROWS_AS(readChunks(filename, compatibility), MSXException);
+	writeRawChunk(filename, 0xFFFFFFFF, compressed);
+	CHECK_THROWS_AS(readChunks(filename, compatibility), MSXException);
+
+	// not zlib data
+	writeRawChunk(filename, 1000, std::vector<byte>(100, 0xFF));
+	CHECK_THROWS_AS(readChunks(filename, compatibility), MSXException);
+}
+
+TEST_CASE("BinaryReplayFile: MemInputArchive bounds")
+{
+	MemOutputArchive out;
+	std::string s = "openMSX";
+	std::vector<int> v = {1, 2, 3};
+	EmuTime t = EmuTime::zero + EmuDuration(1.5);
+	unsigned u = 1234;
+	out.serialize("s", s);
+	out.serialize("v", v);
+	out.serialize("t", t);
+	out.serialize("u", u);
+	size_t size;
+	auto buf = out.releaseBuffer(size);
+
+	{
+		MemInputArchive in(buf.data(), size);
+		std::string s2; std::vector<int> v2; EmuTime t2 = EmuTime::zero; unsigned u2;
+		in.serialize("s", s2);
+		in.serialize("v", v2);
+		in.serialize("t", t2);
+		in.serialize("u", u2);
+		CHECK(s2 == s);
+		CHECK(v2 == v);
+		CHECK(t2 == t);
+		CHECK(u2 == u);
+	}
+	// Reading from any truncated buffer must throw.
+	for (size_t len = 0; len < size; ++len) {
+		MemInputArchive in(buf.data(), len);
+		std::string s2; std::vector<int> v2; EmuTime t2 = EmuTime::zero; unsigned u2;
+		CHECK_THROWS_AS([&] {
+			in.serialize("s", s2);
+			in.serialize("v", v2);
+			in.serialize("t", t2);
+			in.serialize("u", u2);
+		}(), MSXException);
+	}
+	// A string length larger than the data.
+	{
+		size_t huge = size_t(-1) / 2;
+		MemInputArchive in(reinterpret_cast<const byte*>(&huge), sizeof(huge));
+		std::string s2;
+		CHECK_THROWS_AS(in.serialize("s", s2), MSXException);
+	}
+}
+
+TEST_CASE("BinaryReplayFile: crafted collection size")
+{
+	// A chunk with a valid hash and valid zlib data, but with a collection
+	// size that doesn't match the data.
+	auto filename = tempFile();
+	std::string compatibility;
+	for (int n : {-1, -0x7FFFFFFF, 4, 0x7FFFFFFF}) {
+		MemOutputArchive out;
+		out.serialize("size", n);
+		int elem = 5;
+		out.serialize("item", elem); // only one element
+		size_t size;
+		auto buf = out.releaseBuffer(size);
+		{
+			File file(filename, File::TRUNCATE);
+			BinaryReplayFile::writeHeader(file, "test 1.0");
+			BinaryReplayFile::writeChunk(file, 2, buf.data(), size);
+		}
+		auto chunks = readChunks(filename, compatibility);
+		REQUIRE(chunks.size() == 1);
+		MemInputArchive in(chunks[0].data.data(), chunks[0].data.size());
+		std::vector<int> v;
+		CHECK_THROWS_AS(in.serialize("v", v), MSXException);
+	}
+}
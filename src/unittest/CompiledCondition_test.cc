@@ -0,0 +1,147 @@
+#include "catch.hpp"
+#include "CompiledCondition.hh"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+
+using namespace openmsx;
+
+namespace {
+
+struct TestContext final : CompiledCondition::Context
+{
+	bool readDebuggable(string_view name, int64_t address,
+	                    int64_t& result) override
+	{
+		if (name == "memory") {
+			if ((address < 0) || (address >= 0x10000)) return false;
+			result = memory[address];
+		} else if (name == "CPU regs") {
+			if ((address < 0) || (address >= 28)) return false;
+			result = regs[address];
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	bool getVariable(const std::string& name, int64_t& result) override
+	{
+		auto it = variables.find(name);
+		if (it == variables.end()) return false;
+		result = it->second;
+		return true;
+	}
+
+	void getSelectedSlot(unsigned page, int& ps, int& ss) override
+	{
+		ps = (page == 0) ? 0 : 3;
+		ss = (page == 0) ? -1 : 1;
+	}
+
+	uint8_t memory[0x10000] = {};
+	uint8_t regs[28] = {};
+	std::map<std::string, int64_t> variables;
+};
+
+bool eval(TestContext& context, string_view expression)
+{
+	auto c = CompiledCondition::compile(expression);
+	REQUIRE(c);
+	bool result = false;
+	REQUIRE(c->evaluate(context, result));
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("CompiledCondition: operators")
+{
+	TestContext context;
+	CHECK( eval(context, "1"));
+	CHECK(!eval(context, "0"));
+	CHECK( eval(context, "1 + 2 * 3 == 7"));
+	CHECK( eval(context, "(1 + 2) * 3 == 9"));
+	CHECK( eval(context, "0x10 == 16 && 0b101 == 5 && 0o17 == 15"));
+	CHECK( eval(context, "-7 / 2 == -4 && -7 % 2 == 1")); // like Tcl
+	CHECK( eval(context, "1 << 4 == 16 && 256 >> 4 == 16"));
+	CHECK( eval(context, "(6 & 3) == 2 && (6 | 3) == 7 && (6 ^ 3) == 5"));
+	CHECK( eval(context, "~0 == -1 && !0 && !!5"));
+	CHECK( eval(context, "3 < 4 && 4 <= 4 && 5 > 4 && 4 >= 4 && 3 != 4"));
+	CHECK( eval(context, "0 || 2"));
+	CHECK(!eval(context, "0 && 2"));
+	CHECK( eval(context, "1 ? 5 == 5 : 0"));
+	CHECK( eval(context, "0 ? 0 : 1"));
+}
+
+TEST_CASE("CompiledCondition: commands and variables")
+{
+	TestContext context;
+	context.regs[0] = 0x12; // A
+	context.regs[1] = 0x34; // F
+	context.regs[20] = 0x41; // PC = 0x4100
+	context.regs[21] = 0x00;
+	context.memory[0xC000] = 0xFE;
+	context.memory[0xC001] = 0x01;
+	context.variables["wp_last_address"] = 0xC000;
+	context.variables["::wp_last_address"] = 0xC000;
+
+	CHECK(eval(context, "[reg A] == 0x12"));
+	CHECK(eval(context, "[reg af] == 0x1234"));
+	CHECK(eval(context, "[peek 0xC000] == 254"));
+	CHECK(eval(context, "[peek_s8 0xC000] == -2"));
+	CHECK(eval(context, "[peek16 0xC000] == 0x01FE"));
+	CHECK(eval(context, "[peek16_BE 0xC000] == 0xFE01"));
+	CHECK(eval(context, "[peek $wp_last_address] == 254"));
+	CHECK(eval(context, "[peek ${wp_last_address} {memory}] == 254"));
+	CHECK(eval(context, "[debug read \"memory\" 0xC001] == 1"));
+	CHECK(eval(context, "[expr {[reg PC] + 1}] == 0x4101"));
+	CHECK(eval(context, "[pc_in_slot 3 1]"));
+	CHECK(eval(context, "[pc_in_slot 3 X] && ![pc_in_slot 3 2]"));
+	CHECK(eval(context, "![watch_in_slot 0]"));
+}
+
+TEST_CASE("CompiledCondition: fallback to Tcl")
+{
+	// not in the supported subset
+	CHECK(!CompiledCondition::compile(""));
+	CHECK(!CompiledCondition::compile("010 == 8")); // octal or not?
+	CHECK(!CompiledCondition::compile("1.5 > 1"));
+	CHECK(!CompiledCondition::compile("2 ** 3"));
+	CHECK(!CompiledCondition::compile("\"a\" eq \"a\""));
+	CHECK(!CompiledCondition::compile("abs(-1)"));
+	CHECK(!CompiledCondition::compile("$a(1)"));
+	CHECK(!CompiledCondition::compile("[my_proc 1]"));
+	CHECK(!CompiledCondition::compile("[reg XYZ]"));
+	CHECK(!CompiledCondition::compile("[peek 0x10; peek 0x20]"));
+	CHECK(!CompiledCondition::compile("[pc_in_slot 1] == 1")); // 'true'
+
+	// can't be evaluated, Tcl will report the error
+	TestContext context;
+	bool result;
+	auto c1 = CompiledCondition::compile("$unknown == 1");
+	REQUIRE(c1);
+	CHECK(!c1->evaluate(context, result));
+	auto c2 = CompiledCondition::compile("1 / 0");
+	REQUIRE(c2);
+	CHECK(!c2->evaluate(context, result));
+	auto c3 = CompiledCondition::compile("[peek16 0xFFFF]");
+	REQUIRE(c3);
+	CHECK(!c3->evaluate(context, result));
+
+	// Tcl would promote the result to a bignum
+	context.variables["max"] = std::numeric_limits<int64_t>::max();
+	context.variables["min"] = std::numeric_limits<int64_t>::min();
+	for (auto* expr : {"$max + 1 > 0", "$min - 1 < 0", "$max * 2 > 0",
+	                   "$min * -1 > 0", "-$min > 0", "$max * -2 < 0"}) {
+		auto c = CompiledCondition::compile(expr);
+		REQUIRE(c);
+		CHECK(!c->evaluate(context, result));
+	}
+	// but these still fit
+	CHECK(eval(context, "$max - 1 + 1 == $max"));
+	CHECK(eval(context, "$min + 1 - 1 == $min"));
+	CHECK(eval(context, "$min * 1 == $min && $min / 1 == $min"));
+	CHECK(eval(context, "-$max - 1 == $min"));
+}
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+#include "PatternExpand.hh"
+#include <cstdint>
+#include <vector>
+
+using namespace openmsx;
+
+// Reference implementations, these are the per-character routines that
+// CharacterConverter used before the whole-line kernels.
+template<typename Pixel> static void draw6(
+	Pixel*& pixelPtr, Pixel fg, Pixel bg, byte pattern)
+{
+	for (int i = 0; i < 6; ++i) {
+		*pixelPtr++ = (pattern & (0x80 >> i)) ? fg : bg;
+	}
+}
+template<typename Pixel> static void draw8(
+	Pixel*& pixelPtr, Pixel fg, Pixel bg, byte pattern)
+{
+	for (int i = 0; i < 8; ++i) {
+		*pixelPtr++ = (pattern & (0x80 >> i)) ? fg : bg;
+	}
+}
+
+template<typename Pixel> static Pixel color(unsigned i)
+{
+	return Pixel(0x9E3779B9u * (i + 1));
+}
+
+template<typename Pixel> static void testDraw8()
+{
+	Pixel fg = color<Pixel>(1);
+	Pixel bg = color<Pixel>(2);
+	for (unsigned p = 0; p < 256; ++p) {
+		Pixel expected[8], actual[8];
+		Pixel* e = expected;
+		draw8(e, fg, bg, p);
+		PatternExpand::draw8(actual, fg, bg, p);
+		for (int i = 0; i < 8; ++i) CHECK(actual[i] == expected[i]);
+	}
+}
+
+template<typename Pixel> static void testMono(unsigned num)
+{
+	std::vector<byte> patterns(num);
+	for (unsigned i = 0; i < num; ++i) patterns[i] = i * 37 + 11;
+	Pixel fg = color<Pixel>(3);
+	Pixel bg = color<Pixel>(4);
+
+	std::vector<Pixel> expected(8 * num), actual(8 * num);
+	Pixel* e = expected.data();
+	for (unsigned i = 0; i < num; ++i) draw8(e, fg, bg, patterns[i]);
+	PatternExpand::mono(actual.data(), patterns.data(), num, fg, bg);
+	CHECK(actual == expected);
+}
+
+template<typename Pixel> static void testColor(unsigned num)
+{
+	std::vector<byte> patterns(num);
+	std::vector<Pixel> fgs(num), bgs(num);
+	for (unsigned i = 0; i < num; ++i) {
+		patterns[i] = i * 91 + 5;
+		fgs[i] = color<Pixel>(2 * i + 0);
+		bgs[i] = color<Pixel>(2 * i + 1);
+	}
+
+	std::vector<Pixel> expected(8 * num), actual(8 * num);
+	Pixel* e = expected.data();
+	for (unsigned i = 0; i < num; ++i) draw8(e, fgs[i], bgs[i], patterns[i]);
+	PatternExpand::color(actual.data(), patterns.data(),
+	                     fgs.data(), bgs.data(), num);
+	CHECK(actual == expected);
+}
+
+// A Text1 line: 40 characters of 6 pixels, all in the same colors.
+template<typename Pixel> static void testText1()
+{
+	byte patterns[40];
+	for (unsigned i = 0; i < 40; ++i) patterns[i] = i * 29 + 3;
+	Pixel fg = color<Pixel>(5);
+	Pixel bg = color<Pixel>(6);
+
+	Pixel expected[240], actual[240];
+	Pixel* e = expected;
+	for (unsigned i = 0; i < 40; ++i) draw6(e, fg, bg, patterns[i]);
+
+	byte packed[30];
+	PatternExpand::pack6(packed, patterns, 40);
+	PatternExpand::mono(actual, packed, 30, fg, bg);
+	for (int i = 0; i < 240; ++i) CHECK(actual[i] == expected[i]);
+}
+
+// A Text2 line: 80 characters of 6 pixels with blink attributes.
+template<typename Pixel> static void testText2Blink()
+{
+	byte patterns[80];
+	byte attributes[10];
+	for (unsigned i = 0; i < 80; ++i) patterns[i] = i * 53 + 7;
+	for (unsigned i = 0; i < 10; ++i) attributes[i] = i * 67 + 1;
+	Pixel plainFg = color<Pixel>(7);
+	Pixel plainBg = color<Pixel>(8);
+	Pixel blinkFg = color<Pixel>(9);
+	Pixel blinkBg = color<Pixel>(10);
+
+	Pixel expected[480], actual[480];
+	Pixel* e = expected;
+	for (unsigned i = 0; i < 80; ++i) {
+		bool b = (attributes[i / 8] & (0x80 >> (i % 8))) != 0;
+		draw6(e, b ? blinkFg : plainFg, b ? blinkBg : plainBg, patterns[i]);
+	}
+
+	byte selects[80];
+	for (unsigned i = 0; i < 80; ++i) {
+		selects[i] = (attributes[i / 8] & (0x80 >> (i % 8))) ? 0xFC : 0x00;
+	}
+	byte packed[60], packedSelects[60];
+	PatternExpand::pack6(packed, patterns, 80);
+	PatternExpand::pack6(packedSelects, selects, 80);
+	PatternExpand::blink(actual, packed, packedSelects, 60,
+	                     plainFg, plainBg, blinkFg, blinkBg);
+	for (int i = 0; i < 480; ++i) CHECK(actual[i] == expected[i]);
+}
+
+template<typename Pixel> static void testAll()
+{
+	testDraw8<Pixel>();
+	for (unsigned num : {1, 3, 4, 5, 30, 32, 60}) {
+		testMono <Pixel>(num);
+		testColor<Pixel>(num);
+	}
+	testText1<Pixel>();
+	testText2Blink<Pixel>();
+}
+
+TEST_CASE("PatternExpand")
+{
+	SECTION("16bpp") { testAll<uint16_t>(); }
+	SECTION("32bpp") { testAll<uint32_t>(); }
+}
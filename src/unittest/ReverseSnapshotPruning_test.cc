@@ -0,0 +1,103 @@
+#include "catch.hpp"
+#include "ReverseSnapshotPruning.hh"
+#include <map>
+
+using namespace openmsx;
+using namespace ReverseSnapshotPruning;
+
+struct Chunk {
+	EmuTime time;
+};
+using Chunks = std::map<unsigned, Chunk>;
+
+static EmuTime at(unsigned seconds)
+{
+	return EmuTime::zero + EmuDuration(double(seconds));
+}
+
+static void addSnapshot(Chunks& chunks, unsigned seqNum)
+{
+	dropOldSnapshots<25>(chunks, seqNum);
+	dropOutOfWindow<25>(chunks, seqNum);
+	chunks.emplace(seqNum, Chunk{at(seqNum)});
+}
+
+// Like ReverseManager::fillGaps(): add extra snapshots (at half the max
+// distance) in the gaps that end in the window.
+static void fillGaps(Chunks& chunks)
+{
+	for (auto it = begin(chunks); std::next(it) != end(chunks); ++it) {
+		auto next = std::next(it);
+		if (!inMaxGapWindow(chunks, next->second.time)) continue;
+		auto gap = MAX_SNAPSHOT_GAP.toDouble();
+		auto step = unsigned(gap / 2);
+		for (unsigned s = it->first; (next->first - s) > gap; s += step) {
+			chunks.emplace(s + step, Chunk{at(s + step)});
+		}
+	}
+}
+
+// Largest distance between two snapshots that end in the window.
+static double maxGapInWindow(const Chunks& chunks)
+{
+	double result = 0.0;
+	for (auto it = begin(chunks); std::next(it) != end(chunks); ++it) {
+		auto next = std::next(it);
+		if (!inMaxGapWindow(chunks, next->second.time)) continue;
+		result = std::max(result,
+		                  (next->second.time - it->second.time).toDouble());
+	}
+	return result;
+}
+
+static size_t countWithoutMaxGap(unsigned last)
+{
+	size_t result = 0;
+	for (unsigned s = 0; s <= last; ++s) {
+		if ((s == 0) || !isDropped<25>(s, last)) ++result;
+	}
+	return result;
+}
+
+TEST_CASE("ReverseSnapshotPruning: isDropped")
+{
+	// Same result as actually running dropOldSnapshots() on all snapshots
+	// (without gaps, so the MAX_SNAPSHOT_GAP rule never applies).
+	std::map<unsigned, int> chunks;
+	for (unsigned count = 0; count < 5000; ++count) {
+		unsigned y = (count + 25) ^ (count + 26);
+		unsigned d = 25;
+		unsigned d2 = 51;
+		while (true) {
+			y >>= 1;
+			if ((y == 0) || (count < d)) break;
+			chunks.erase(count - d);
+			d += d2;
+			d2 *= 2;
+		}
+		chunks[count] = 0;
+	}
+	for (unsigned s = 1; s < 5000; ++s) {
+		CHECK(isDropped<25>(s, 4999) == (chunks.count(s) == 0));
+	}
+}
+
+TEST_CASE("ReverseSnapshotPruning: number of snapshots")
+{
+	Chunks chunks;
+	unsigned seconds = 0;
+	for (unsigned hours : {1, 3, 8}) {
+		for (/**/; seconds <= hours * 3600; ++seconds) {
+			addSnapshot(chunks, seconds);
+			fillGaps(chunks);
+			CHECK(maxGapInWindow(chunks) <= MAX_SNAPSHOT_GAP.toDouble());
+		}
+		// Before the window there are no more snapshots than without the
+		// MAX_SNAPSHOT_GAP rule, in the window at most one every 5s.
+		auto window = size_t(MAX_GAP_WINDOW.toDouble()) / 5;
+		INFO("after " << hours << " hours");
+		CHECK(chunks.size() <= countWithoutMaxGap(seconds - 1) + window);
+	}
+	// so the number only grows logarithmically
+	CHECK(chunks.size() < 300);
+}
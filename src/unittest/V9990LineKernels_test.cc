@@ -0,0 +1,103 @@
+#include "catch.hpp"
+#include "V9990LineKernels.hh"
+#include "Math.hh"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace openmsx;
+
+// Reference implementation, this is the per-pixel routine the V9990 bitmap
+// converter used before.
+template<bool YJK> static void refYuv(uint16_t* out, const byte* data)
+{
+	int u = (data[2] & 7) + ((data[3] & 3) << 3) - ((data[3] & 4) << 3);
+	int v = (data[0] & 7) + ((data[1] & 3) << 3) - ((data[1] & 4) << 3);
+	for (int i = 0; i < 4; ++i) {
+		int y = (data[i] & 0xF8) >> 3;
+		int r = Math::clip<0, 31>(y + u);
+		int g = Math::clip<0, 31>((5 * y - 2 * u - v) / 4);
+		int b = Math::clip<0, 31>(y + v);
+		if (YJK) std::swap(g, b);
+		out[i] = (g << 10) + (r << 5) + b;
+	}
+}
+
+template<bool YJK> static void testYuv()
+{
+	// Every combination of the (signed) U and V components, each with a
+	// different set of Y values. Plus an odd number of groups to exercise
+	// the non-SIMD tail.
+	std::vector<byte> data;
+	for (unsigned uv = 0; uv < 64 * 64; ++uv) {
+		unsigned u = uv & 63;
+		unsigned v = uv >> 6;
+		byte y0 = (uv * 8 +  0) & 0xF8;
+		byte y1 = (uv * 24 + 8) & 0xF8;
+		data.push_back(y0 | ((v >> 0) & 7));
+		data.push_back(y1 | ((v >> 3) & 7));
+		data.push_back(byte(~y0 & 0xF8) | ((u >> 0) & 7));
+		data.push_back(byte(~y1 & 0xF8) | ((u >> 3) & 7));
+	}
+	for (int i = 0; i < 4; ++i) data.push_back(0xF8 | i);
+	unsigned numGroups = data.size() / 4;
+
+	std::vector<uint16_t> expected(data.size()), actual(data.size());
+	for (unsigned g = 0; g < numGroups; ++g) {
+		refYuv<YJK>(&expected[4 * g], &data[4 * g]);
+	}
+	V9990LineKernels::yuvToIndex<YJK>(actual.data(), data.data(), numGroups);
+	CHECK(actual == expected);
+}
+
+template<typename Pixel> static void testTiles()
+{
+	Pixel palette[16];
+	for (int i = 0; i < 16; ++i) palette[i] = Pixel(0x9E3779B9u * (i + 1));
+
+	std::vector<uint32_t> patterns = {
+		0x00000000, 0x12345678, 0x9ABCDEF1, 0x10203040,
+		0x01020304, 0xF000000F, 0x11111111, 0x0FFFFFF0,
+		0x80000000, 0x00000001, 0xFFFFFFFF, 0x10101010,
+	};
+	for (unsigned i = 0; i < 64; ++i) patterns.push_back(0x2545F491u * i);
+
+	std::vector<Pixel> expected(8 * patterns.size()), actual;
+	for (unsigned i = 0; i < expected.size(); ++i) expected[i] = Pixel(i);
+	actual = expected;
+	for (unsigned t = 0; t < patterns.size(); ++t) {
+		for (unsigned i = 0; i < 8; ++i) {
+			unsigned c = (patterns[t] >> (28 - 4 * i)) & 15;
+			if (c) expected[8 * t + i] = palette[c];
+		}
+	}
+	V9990LineKernels::drawTiles(actual.data(), patterns.data(),
+	                            patterns.size(), palette);
+	CHECK(actual == expected);
+}
+
+TEST_CASE("V9990LineKernels: interleave")
+{
+	for (unsigned num : {0, 1, 15, 16, 17, 33, 100}) {
+		std::vector<byte> even(num), odd(num);
+		for (unsigned i = 0; i < num; ++i) {
+			even[i] = 2 * i + 0;
+			odd [i] = 2 * i + 1;
+		}
+		std::vector<byte> out(2 * num);
+		V9990LineKernels::interleave(out.data(), even.data(), odd.data(), num);
+		for (unsigned i = 0; i < 2 * num; ++i) CHECK(out[i] == byte(i));
+	}
+}
+
+TEST_CASE("V9990LineKernels: yuvToIndex")
+{
+	SECTION("YUV") { testYuv<false>(); }
+	SECTION("YJK") { testYuv<true>(); }
+}
+
+TEST_CASE("V9990LineKernels: drawTiles")
+{
+	SECTION("16bpp") { testTiles<uint16_t>(); }
+	SECTION("32bpp") { testTiles<uint32_t>(); }
+}
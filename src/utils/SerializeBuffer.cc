@@ -91,11 +91,8 @@ byte* OutputBuffer::allocateGrow(size_t len)
 
 InputBuffer::InputBuffer(const byte* data, size_t size)
 	: buf(data)
-#ifndef NDEBUG
 	, finish(buf + size)
-#endif
 {
-	(void)size;
 }
 
 } // namespace openmsx
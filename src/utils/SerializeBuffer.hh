@@ -172,11 +172,12 @@ public:
 	  */
 	const byte* getCurrentPos() const { return buf; }
 
+	/** Return the number of bytes that can still be read. */
+	size_t getRemaining() const { return finish - buf; }
+
 private:
 	const byte* buf;
-#ifndef NDEBUG
-	const byte* finish; // only used to check asserts
-#endif
+	const byte* finish;
 };
 
 } // namespace openmsx
@@ -10,14 +10,11 @@ TODO:
 #include "CharacterConverter.hh"
 #include "VDP.hh"
 #include "VDPVRAM.hh"
+#include "PatternExpand.hh"
 #include "build-info.hh"
 #include "components.hh"
 #include <cstdint>
 
-#ifdef __SSE2__
-#include "emmintrin.h" // SSE2
-#endif
-
 namespace openmsx {
 
 template <class Pixel>
@@ -81,63 +78,6 @@ void CharacterConverter<Pixel>::convertLine(Pixel* linePtr, int line)
 	}
 }
 
-#ifdef __SSE2__
-// Copied from Scale2xScaler.cc, TODO move to common location?
-static inline __m128i select(__m128i a0, __m128i a1, __m128i mask)
-{
-	return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a0, a1), mask), a0);
-}
-#endif
-
-template<typename Pixel> static inline void draw6(
-	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
-{
-	pixelPtr[0] = (pattern & 0x80) ? fg : bg;
-	pixelPtr[1] = (pattern & 0x40) ? fg : bg;
-	pixelPtr[2] = (pattern & 0x20) ? fg : bg;
-	pixelPtr[3] = (pattern & 0x10) ? fg : bg;
-	pixelPtr[4] = (pattern & 0x08) ? fg : bg;
-	pixelPtr[5] = (pattern & 0x04) ? fg : bg;
-	pixelPtr += 6;
-}
-
-template<typename Pixel> static inline void draw8(
-	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
-{
-#ifdef __SSE2__
-	// SSE2 version, 32bpp  (16bpp is possible, but not worth it anymore)
-	if (sizeof(Pixel) == 4) {
-		const __m128i m74 = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
-		const __m128i m30 = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
-		const __m128i zero = _mm_setzero_si128();
-
-		__m128i fg4 = _mm_set1_epi32(fg);
-		__m128i bg4 = _mm_set1_epi32(bg);
-		__m128i pat = _mm_set1_epi32(pattern);
-
-		__m128i b74 = _mm_cmpeq_epi32(_mm_and_si128(pat, m74), zero);
-		__m128i b30 = _mm_cmpeq_epi32(_mm_and_si128(pat, m30), zero);
-
-		auto* out = reinterpret_cast<__m128i*>(pixelPtr);
-		_mm_storeu_si128(out + 0, select(fg4, bg4, b74));
-		_mm_storeu_si128(out + 1, select(fg4, bg4, b30));
-		pixelPtr += 8;
-		return;
-	}
-#endif
-
-	// C++ version
-	pixelPtr[0] = (pattern & 0x80) ? fg : bg;
-	pixelPtr[1] = (pattern & 0x40) ? fg : bg;
-	pixelPtr[2] = (pattern & 0x20) ? fg : bg;
-	pixelPtr[3] = (pattern & 0x10) ? fg : bg;
-	pixelPtr[4] = (pattern & 0x08) ? fg : bg;
-	pixelPtr[5] = (pattern & 0x04) ? fg : bg;
-	pixelPtr[6] = (pattern & 0x02) ? fg : bg;
-	pixelPtr[7] = (pattern & 0x01) ? fg : bg;
-	pixelPtr += 8;
-}
-
 template <class Pixel>
 void CharacterConverter<Pixel>::renderText1(
 	Pixel* __restrict pixelPtr, int line)
@@ -152,13 +92,16 @@ void CharacterConverter<Pixel>::renderText1(
 	// Note: Because line width is not a power of two, reading an entire line
 	//       from a VRAM pointer returned by readArea will not wrap the index
 	//       correctly. Therefore we read one character at a time.
+	byte patterns[40];
 	unsigned nameStart = (line / 8) * 40;
-	unsigned nameEnd = nameStart + 40;
-	for (unsigned name = nameStart; name < nameEnd; ++name) {
-		unsigned charcode = vram.nameTable.readNP((name + 0xC00) | (~0u << 12));
-		unsigned pattern = patternArea[charcode * 8];
-		draw6(pixelPtr, fg, bg, pattern);
+	for (unsigned i = 0; i < 40; ++i) {
+		unsigned charcode = vram.nameTable.readNP(
+			(nameStart + i + 0xC00) | (~0u << 12));
+		patterns[i] = patternArea[charcode * 8];
 	}
+	byte packed[40 * 6 / 8];
+	PatternExpand::pack6(packed, patterns, 40);
+	PatternExpand::mono(pixelPtr, packed, 40 * 6 / 8, fg, bg);
 }
 
 template <class Pixel>
@@ -173,16 +116,19 @@ void CharacterConverter<Pixel>::renderText1Q(
 	// Note: Because line width is not a power of two, reading an entire line
 	//       from a VRAM pointer returned by readArea will not wrap the index
 	//       correctly. Therefore we read one character at a time.
+	byte patterns[40];
 	unsigned nameStart = (line / 8) * 40;
-	unsigned nameEnd = nameStart + 40;
 	unsigned patternQuarter = (line & 0xC0) << 2;
-	for (unsigned name = nameStart; name < nameEnd; ++name) {
-		unsigned charcode = vram.nameTable.readNP((name + 0xC00) | (~0u << 12));
+	for (unsigned i = 0; i < 40; ++i) {
+		unsigned charcode = vram.nameTable.readNP(
+			(nameStart + i + 0xC00) | (~0u << 12));
 		unsigned patternNr = patternQuarter | charcode;
-		unsigned pattern = vram.patternTable.readNP(
+		patterns[i] = vram.patternTable.readNP(
 			patternBaseLine | (patternNr * 8));
-		draw6(pixelPtr, fg, bg, pattern);
 	}
+	byte packed[40 * 6 / 8];
+	PatternExpand::pack6(packed, patterns, 40);
+	PatternExpand::mono(pixelPtr, packed, 40 * 6 / 8, fg, bg);
 }
 
 template <class Pixel>
@@ -191,60 +137,49 @@ void CharacterConverter<Pixel>::renderText2(
 {
 	Pixel plainFg = palFg[vdp.getForegroundColor()];
 	Pixel plainBg = palFg[vdp.getBackgroundColor()];
-	Pixel blinkFg, blinkBg;
-	if (vdp.getBlinkState()) {
-		int fg = vdp.getBlinkForegroundColor();
-		blinkFg = palBg[fg ? fg : vdp.getBlinkBackgroundColor()];
-		blinkBg = palBg[vdp.getBlinkBackgroundColor()];
-	} else {
-		blinkFg = plainFg;
-		blinkBg = plainBg;
-	}
 
 	// 8 * 256 is small enough to always be contiguous
 	const byte* patternArea = vram.patternTable.getReadArea(0, 256 * 8);
 	patternArea += (line + vdp.getVerticalScroll()) & 7;
 
+	byte patterns[80];
+	unsigned nameStart = (line / 8) * 80;
+	for (unsigned i = 0; i < (80 / 8); ++i) {
+		const byte* nameArea = vram.nameTable.getReadArea(
+			(nameStart + 8 * i) | (~0u << 12), 8);
+		for (unsigned j = 0; j < 8; ++j) {
+			patterns[8 * i + j] = patternArea[nameArea[j] * 8];
+		}
+	}
+	byte packed[80 * 6 / 8];
+	PatternExpand::pack6(packed, patterns, 80);
+
+	if (!vdp.getBlinkState()) {
+		// Blink attributes have no visible effect, so all characters
+		// use the same colors.
+		PatternExpand::mono(pixelPtr, packed, 80 * 6 / 8, plainFg, plainBg);
+		return;
+	}
+
+	int blinkFgIdx = vdp.getBlinkForegroundColor();
+	Pixel blinkFg = palBg[blinkFgIdx ? blinkFgIdx : vdp.getBlinkBackgroundColor()];
+	Pixel blinkBg = palBg[vdp.getBlinkBackgroundColor()];
+
+	// Expand the per-character blink attribute bits to the same 6-pixel
+	// layout as the patterns.
+	byte selects[80];
 	unsigned colorStart = (line / 8) * (80 / 8);
-	unsigned nameStart  = (line / 8) * 80;
 	for (unsigned i = 0; i < (80 / 8); ++i) {
 		unsigned colorPattern = vram.colorTable.readNP(
 			(colorStart + i) | (~0u << 9));
-		const byte* nameArea = vram.nameTable.getReadArea(
-			(nameStart + 8 * i) | (~0u << 12), 8);
-		draw6(pixelPtr,
-		      (colorPattern & 0x80) ? blinkFg : plainFg,
-		      (colorPattern & 0x80) ? blinkBg : plainBg,
-		      patternArea[nameArea[0] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x40) ? blinkFg : plainFg,
-		      (colorPattern & 0x40) ? blinkBg : plainBg,
-		      patternArea[nameArea[1] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x20) ? blinkFg : plainFg,
-		      (colorPattern & 0x20) ? blinkBg : plainBg,
-		      patternArea[nameArea[2] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x10) ? blinkFg : plainFg,
-		      (colorPattern & 0x10) ? blinkBg : plainBg,
-		      patternArea[nameArea[3] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x08) ? blinkFg : plainFg,
-		      (colorPattern & 0x08) ? blinkBg : plainBg,
-		      patternArea[nameArea[4] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x04) ? blinkFg : plainFg,
-		      (colorPattern & 0x04) ? blinkBg : plainBg,
-		      patternArea[nameArea[5] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x02) ? blinkFg : plainFg,
-		      (colorPattern & 0x02) ? blinkBg : plainBg,
-		      patternArea[nameArea[6] * 8]);
-		draw6(pixelPtr,
-		      (colorPattern & 0x01) ? blinkFg : plainFg,
-		      (colorPattern & 0x01) ? blinkBg : plainBg,
-		      patternArea[nameArea[7] * 8]);
+		for (unsigned j = 0; j < 8; ++j) {
+			selects[8 * i + j] = (colorPattern & (0x80 >> j)) ? 0xFC : 0x00;
+		}
 	}
+	byte packedSelects[80 * 6 / 8];
+	PatternExpand::pack6(packedSelects, selects, 80);
+	PatternExpand::blink(pixelPtr, packed, packedSelects, 80 * 6 / 8,
+	                     plainFg, plainBg, blinkFg, blinkBg);
 }
 
 template <class Pixel>
@@ -263,17 +198,19 @@ void CharacterConverter<Pixel>::renderGraphic1(
 	patternArea += line & 7;
 	const byte* colorArea = vram.colorTable.getReadArea(0, 256 / 8);
 
+	byte patterns[32];
+	Pixel fgs[32], bgs[32];
 	int scroll = vdp.getHorizontalScrollHigh();
 	const byte* namePtr = getNamePtr(line, scroll);
 	for (unsigned n = 0; n < 32; ++n) {
 		unsigned charcode = namePtr[scroll & 0x1F];
-		unsigned pattern = patternArea[charcode * 8];
+		patterns[n] = patternArea[charcode * 8];
 		unsigned color = colorArea[charcode / 8];
-		Pixel fg = palFg[color >> 4];
-		Pixel bg = palFg[color & 0x0F];
-		draw8(pixelPtr, fg, bg, pattern);
+		fgs[n] = palFg[color >> 4];
+		bgs[n] = palFg[color & 0x0F];
 		if (!(++scroll & 0x1F)) namePtr = getNamePtr(line, scroll);
 	}
+	PatternExpand::color(pixelPtr, patterns, fgs, bgs, 32);
 }
 
 template <class Pixel>
@@ -285,6 +222,8 @@ void CharacterConverter<Pixel>::renderGraphic2(
 	int scroll = vdp.getHorizontalScrollHigh();
 	const byte* namePtr = getNamePtr(line, scroll);
 
+	byte patterns[32];
+	Pixel fgs[32], bgs[32];
 	if (vram.colorTable  .isContinuous((8 * 256) - 1) &&
 	    vram.patternTable.isContinuous((8 * 256) - 1) &&
 	    ((scroll & 0x1f) == 0)) {
@@ -295,11 +234,10 @@ void CharacterConverter<Pixel>::renderGraphic2(
 		const byte* colorArea   = vram.colorTable  .getReadArea(quarter8, 8 * 256) + line7;
 		for (unsigned n = 0; n < 32; ++n) {
 			unsigned charCode8 = namePtr[n] * 8;
-			unsigned pattern = patternArea[charCode8];
-			unsigned color   = colorArea  [charCode8];
-			Pixel fg = palFg[color >> 4];
-			Pixel bg = palFg[color & 0x0F];
-			draw8(pixelPtr, fg, bg, pattern);
+			patterns[n] = patternArea[charCode8];
+			unsigned color = colorArea[charCode8];
+			fgs[n] = palFg[color >> 4];
+			bgs[n] = palFg[color & 0x0F];
 		}
 	} else {
 		// Slower variant, also works when:
@@ -310,14 +248,14 @@ void CharacterConverter<Pixel>::renderGraphic2(
 		for (unsigned n = 0; n < 32; ++n) {
 			unsigned charCode8 = namePtr[scroll & 0x1F] * 8;
 			unsigned index = charCode8 | baseLine;
-			unsigned pattern = vram.patternTable.readNP(index);
-			unsigned color   = vram.colorTable  .readNP(index);
-			Pixel fg = palFg[color >> 4];
-			Pixel bg = palFg[color & 0x0F];
-			draw8(pixelPtr, fg, bg, pattern);
+			patterns[n] = vram.patternTable.readNP(index);
+			unsigned color = vram.colorTable.readNP(index);
+			fgs[n] = palFg[color >> 4];
+			bgs[n] = palFg[color & 0x0F];
 			if (!(++scroll & 0x1F)) namePtr = getNamePtr(line, scroll);
 		}
 	}
+	PatternExpand::color(pixelPtr, patterns, fgs, bgs, 32);
 }
 
 template <class Pixel>
@@ -325,21 +263,26 @@ void CharacterConverter<Pixel>::renderMultiHelper(
 	Pixel* __restrict pixelPtr, int line,
 	int mask, int patternQuarter)
 {
+	// Each character is a left and a right block of 4 pixels, this is
+	// the same as expanding pattern 0xF0 with the two block colors.
+	static const byte patterns[32] = {
+		0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+		0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+		0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+		0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+	};
+	Pixel cls[32], crs[32];
 	unsigned baseLine = mask | ((line / 4) & 7);
 	unsigned scroll = vdp.getHorizontalScrollHigh();
 	const byte* namePtr = getNamePtr(line, scroll);
 	for (unsigned n = 0; n < 32; ++n) {
 		unsigned patternNr = patternQuarter | namePtr[scroll & 0x1F];
 		unsigned color = vram.patternTable.readNP((patternNr * 8) | baseLine);
-		Pixel cl = palFg[color >> 4];
-		Pixel cr = palFg[color & 0x0F];
-		pixelPtr[0] = cl; pixelPtr[1] = cl;
-		pixelPtr[2] = cl; pixelPtr[3] = cl;
-		pixelPtr[4] = cr; pixelPtr[5] = cr;
-		pixelPtr[6] = cr; pixelPtr[7] = cr;
-		pixelPtr += 8;
+		cls[n] = palFg[color >> 4];
+		crs[n] = palFg[color & 0x0F];
 		if (!(++scroll & 0x1F)) namePtr = getNamePtr(line, scroll);
 	}
+	PatternExpand::color(pixelPtr, patterns, cls, crs, 32);
 }
 template <class Pixel>
 void CharacterConverter<Pixel>::renderMulti(
@@ -5,6 +5,7 @@
 #include "vla.hh"
 #include "build-info.hh"
 #include <cassert>
+#include <cstring>
 #include <memory>
 #ifdef __SSE2__
 #include <emmintrin.h>
@@ -135,6 +136,13 @@ const void* DeflickerImpl<Pixel>::getLineInfo(
 		width = width0;
 		return line0;
 	}
+	if (memcmp(line0, line1, width0 * sizeof(Pixel)) == 0) {
+		// The two most recent frames are identical (a static image,
+		// the common case). Then every pixel either blends with an
+		// identical pixel or isn't blended, so the result is 'line0'.
+		width = width0;
+		return line0;
+	}
 
 	// Prefer to write directly to the output buffer, if that's not
 	// possible store the intermediate result in a temp buffer.
@@ -3,6 +3,7 @@
 #include "Layer.hh"
 #include "VideoSystem.hh"
 #include "VideoLayer.hh"
+#include "PostProcessor.hh"
 #include "EventDistributor.hh"
 #include "FinishFrameEvent.hh"
 #include "FileOperations.hh"
@@ -20,6 +21,7 @@
 #include "VideoSystemChangeListener.hh"
 #include "CommandException.hh"
 #include "StringOp.hh"
+#include "strCat.hh"
 #include "Version.hh"
 #include "build-info.hh"
 #include "checked_cast.hh"
@@ -39,11 +41,33 @@ Display::Display(Reactor& reactor_)
 	: RTSchedulable(reactor_.getRTScheduler())
 	, screenShotCmd(reactor_.getCommandController())
 	, fpsInfo(reactor_.getOpenMSXInfoCommand())
+	, frameHashInfo(reactor_.getOpenMSXInfoCommand())
 	, osdGui(reactor_.getCommandController(), *this)
 	, reactor(reactor_)
 	, renderSettings(reactor.getCommandController())
 	, commandConsole(reactor.getGlobalCommandController(),
 	                 reactor.getEventDistributor(), *this)
+	, screenShotCompressionSetting(reactor.getCommandController(),
+		"screenshot_compression",
+		"zlib compression level for screenshots: 0 (fast, large files) "
+		"to 9 (slow, small files)", 6, 0, 9)
+	, screenShotFilterSetting(reactor.getCommandController(),
+		"screenshot_filter",
+		"PNG row filter for screenshots, 'adaptive' gives the smallest "
+		"files, the fixed filters encode faster",
+		PNG::SaveOptions::FILTER_DEFAULT,
+		EnumSetting<PNG::SaveOptions::Filter>::Map{
+			{"adaptive", PNG::SaveOptions::FILTER_DEFAULT},
+			{"none",     PNG::SaveOptions::FILTER_NONE},
+			{"sub",      PNG::SaveOptions::FILTER_SUB},
+			{"up",       PNG::SaveOptions::FILTER_UP},
+			{"average",  PNG::SaveOptions::FILTER_AVG},
+			{"paeth",    PNG::SaveOptions::FILTER_PAETH}})
+	, screenShotAsyncSetting(reactor.getCommandController(),
+		"screenshot_async",
+		"encode and write screenshots in the background, the "
+		"'screenshot' command then returns before the file is written",
+		false)
 	, currentRenderer(RenderSettings::UNINITIALIZED)
 	, switchInProgress(false)
 {
@@ -63,6 +87,8 @@ Display::Display(Reactor& reactor_)
 			*this);
 	eventDistributor.registerEventListener(OPENMSX_EXPOSE_EVENT,
 			*this);
+	eventDistributor.registerEventListener(OPENMSX_SCREENSHOT_WRITTEN_EVENT,
+			*this);
 #if PLATFORM_ANDROID
 	eventDistributor.registerEventListener(OPENMSX_FOCUS_EVENT,
 			*this);
@@ -79,11 +105,16 @@ Display::~Display()
 	renderSettings.getFullScreenSetting().detach(*this);
 	renderSettings.getScaleFactorSetting().detach(*this);
 
+	// write all pending screenshots
+	screenShotWriter.reset();
+
 	EventDistributor& eventDistributor = reactor.getEventDistributor();
 #if PLATFORM_ANDROID
 	eventDistributor.unregisterEventListener(OPENMSX_FOCUS_EVENT,
 			*this);
 #endif
+	eventDistributor.unregisterEventListener(OPENMSX_SCREENSHOT_WRITTEN_EVENT,
+			*this);
 	eventDistributor.unregisterEventListener(OPENMSX_EXPOSE_EVENT,
 			*this);
 	eventDistributor.unregisterEventListener(OPENMSX_MACHINE_LOADED_EVENT,
@@ -195,6 +226,13 @@ int Display::signalEvent(const std::shared_ptr<const Event>& event)
 		// Don't render too often, and certainly not when the screen
 		// will anyway soon be rendered.
 		repaintDelayed(100 * 1000); // 10fps
+	} else if (event->getType() == OPENMSX_SCREENSHOT_WRITTEN_EVENT) {
+		if (screenShotWriter) {
+			for (auto& error : screenShotWriter->takeErrors()) {
+				getCliComm().printWarning(
+					"Failed to take screenshot: ", error);
+			}
+		}
 	} else if (PLATFORM_ANDROID && event->getType() == OPENMSX_FOCUS_EVENT) {
 		// On Android, the rendering must be frozen when the app is sent to
 		// the background, because Android takes away all graphics resources
@@ -218,6 +256,26 @@ int Display::signalEvent(const std::shared_ptr<const Event>& event)
 	return 0;
 }
 
+PNG::SaveOptions Display::getScreenShotOptions()
+{
+	PNG::SaveOptions options;
+	options.compressionLevel = screenShotCompressionSetting.getInt();
+	options.filter = screenShotFilterSetting.getEnum();
+	if (screenShotAsyncSetting.getBoolean()) {
+		if (!screenShotWriter) {
+			auto& distributor = reactor.getEventDistributor();
+			screenShotWriter = std::make_unique<PNG::AsyncWriter>(
+				[&distributor]() {
+					distributor.distributeEvent(
+						std::make_shared<SimpleEvent>(
+							OPENMSX_SCREENSHOT_WRITTEN_EVENT));
+				});
+		}
+		options.asyncWriter = screenShotWriter.get();
+	}
+	return options;
+}
+
 string Display::getWindowTitle()
 {
 	string title = Version::full();
@@ -463,10 +521,12 @@ void Display::ScreenShotCmd::execute(span<const TclObject> tokens, TclObject& re
 	string filename = FileOperations::parseCommandFileArgument(
 		fname, "screenshots", prefix, ".png");
 
+	auto options = display.getScreenShotOptions();
 	if (!rawShot) {
 		// include all layers (OSD stuff, console)
 		try {
-			display.getVideoSystem().takeScreenShot(filename, withOsd);
+			display.getVideoSystem().takeScreenShot(
+				filename, withOsd, options);
 		} catch (MSXException& e) {
 			throw CommandException(
 				"Failed to take screenshot: ", e.getMessage());
@@ -480,7 +540,7 @@ void Display::ScreenShotCmd::execute(span<const TclObject> tokens, TclObject& re
 		}
 		unsigned height = doubleSize ? 480 : 240;
 		try {
-			videoLayer->takeRawScreenShot(height, filename);
+			videoLayer->takeRawScreenShot(height, filename, options);
 		} catch (MSXException& e) {
 			throw CommandException(
 				"Failed to take screenshot: ", e.getMessage());
@@ -532,4 +592,36 @@ string Display::FpsInfoTopic::help(const vector<string>& /*tokens*/) const
 	return "Returns the current rendering speed in frames per second.";
 }
 
+
+// FrameHashInfoTopic
+
+Display::FrameHashInfoTopic::FrameHashInfoTopic(InfoCommand& openMSXInfoCommand)
+	: InfoTopic(openMSXInfoCommand, "frame_hash")
+{
+}
+
+void Display::FrameHashInfoTopic::execute(span<const TclObject> /*tokens*/,
+                           TclObject& result) const
+{
+	auto& display = OUTER(Display, frameHashInfo);
+	if (!display.renderSettings.getFrameHash()) {
+		throw CommandException(
+			"Frame hashing is disabled, enable the frame_hash setting.");
+	}
+	auto postProcessor = dynamic_cast<PostProcessor*>(
+		display.findActiveLayer());
+	if (!postProcessor) {
+		throw CommandException(
+			"Current renderer doesn't support frame hashes.");
+	}
+	result.addListElement(strCat(postProcessor->getFrameHashCount()));
+	result.addListElement(strCat(hex_string<8>(postProcessor->getFrameHash())));
+}
+
+string Display::FrameHashInfoTopic::help(const vector<string>& /*tokens*/) const
+{
+	return "Returns the number and the hash of the last rendered frame of "
+	       "the active video source. Requires the frame_hash setting.";
+}
+
 } // namespace openmsx
@@ -6,6 +6,7 @@
 #include "CommandConsole.hh"
 #include "InfoTopic.hh"
 #include "OSDGUI.hh"
+#include "PNG.hh"
 #include "EventListener.hh"
 #include "LayerListener.hh"
 #include "RTSchedulable.hh"
@@ -64,6 +65,10 @@ public:
 
 	std::string getWindowTitle();
 
+	/** How the 'screenshot' command should write its PNG file, as
+	  * selected by the screenshot_* settings. */
+	PNG::SaveOptions getScreenShotOptions();
+
 private:
 	void resetVideoSystem();
 
@@ -112,12 +117,25 @@ private:
 		std::string help(const std::vector<std::string>& tokens) const override;
 	} fpsInfo;
 
+	struct FrameHashInfoTopic final : InfoTopic {
+		explicit FrameHashInfoTopic(InfoCommand& openMSXInfoCommand);
+		void execute(span<const TclObject> tokens,
+			     TclObject& result) const override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} frameHashInfo;
+
 	OSDGUI osdGui;
 
 	Reactor& reactor;
 	RenderSettings renderSettings;
 	CommandConsole commandConsole;
 
+	IntegerSetting screenShotCompressionSetting;
+	EnumSetting<PNG::SaveOptions::Filter> screenShotFilterSetting;
+	BooleanSetting screenShotAsyncSetting;
+	// Only created when the first asynchronous screenshot is taken.
+	std::unique_ptr<PNG::AsyncWriter> screenShotWriter;
+
 	// the current renderer
 	RenderSettings::RendererID currentRenderer;
 
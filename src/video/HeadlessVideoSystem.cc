@@ -0,0 +1,98 @@
+#include "HeadlessVideoSystem.hh"
+#include "SDLOffScreenSurface.hh"
+#include "SDLSurfacePtr.hh"
+#include "SDLRasterizer.hh"
+#include "V9990SDLRasterizer.hh"
+#include "FBPostProcessor.hh"
+#include "Reactor.hh"
+#include "Display.hh"
+#include "VDP.hh"
+#include "V9990.hh"
+#include "build-info.hh"
+#include <cstdint>
+#include <memory>
+
+#include "components.hh"
+#if COMPONENT_LASERDISC
+#include "LaserdiscPlayer.hh"
+#include "LDSDLRasterizer.hh"
+#endif
+
+namespace openmsx {
+
+// Use a fixed pixel format, so that frame hashes don't depend on the host.
+#if HAVE_32BPP
+using Pixel = uint32_t;
+static const unsigned DEPTH = 32;
+static const uint32_t RMASK = 0x00FF0000;
+static const uint32_t GMASK = 0x0000FF00;
+static const uint32_t BMASK = 0x000000FF;
+#else
+using Pixel = uint16_t;
+static const unsigned DEPTH = 16;
+static const uint32_t RMASK = 0xF800;
+static const uint32_t GMASK = 0x07E0;
+static const uint32_t BMASK = 0x001F;
+#endif
+
+HeadlessVideoSystem::HeadlessVideoSystem(Reactor& reactor)
+	: display(reactor.getDisplay())
+{
+	SDLSurfacePtr prototype(320, 240, DEPTH, RMASK, GMASK, BMASK, 0);
+	screen = std::make_unique<SDLOffScreenSurface>(*prototype);
+}
+
+HeadlessVideoSystem::~HeadlessVideoSystem() = default;
+
+std::unique_ptr<Rasterizer> HeadlessVideoSystem::createRasterizer(VDP& vdp)
+{
+	std::string videoSource = (vdp.getName() == "VDP")
+	                        ? "MSX" // for backwards compatibility
+	                        : vdp.getName();
+	auto& motherBoard = vdp.getMotherBoard();
+	return std::make_unique<SDLRasterizer<Pixel>>(
+		vdp, display, *screen,
+		std::make_unique<FBPostProcessor<Pixel>>(
+			motherBoard, display, *screen,
+			videoSource, 640, 240, true));
+}
+
+std::unique_ptr<V9990Rasterizer> HeadlessVideoSystem::createV9990Rasterizer(
+	V9990& vdp)
+{
+	std::string videoSource = (vdp.getName() == "Sunrise GFX9000")
+	                        ? "GFX9000" // for backwards compatibility
+	                        : vdp.getName();
+	MSXMotherBoard& motherBoard = vdp.getMotherBoard();
+	return std::make_unique<V9990SDLRasterizer<Pixel>>(
+		vdp, display, *screen,
+		std::make_unique<FBPostProcessor<Pixel>>(
+			motherBoard, display, *screen,
+			videoSource, 1280, 240, true));
+}
+
+#if COMPONENT_LASERDISC
+std::unique_ptr<LDRasterizer> HeadlessVideoSystem::createLDRasterizer(
+	LaserdiscPlayer& ld)
+{
+	std::string videoSource = "Laserdisc"; // TODO handle multiple???
+	MSXMotherBoard& motherBoard = ld.getMotherBoard();
+	return std::make_unique<LDSDLRasterizer<Pixel>>(
+		*screen,
+		std::make_unique<FBPostProcessor<Pixel>>(
+			motherBoard, display, *screen,
+			videoSource, 640, 480, false));
+}
+#endif
+
+void HeadlessVideoSystem::flush()
+{
+}
+
+OutputSurface* HeadlessVideoSystem::getOutputSurface()
+{
+	// Nothing is ever painted.
+	return nullptr;
+}
+
+} // namespace openmsx
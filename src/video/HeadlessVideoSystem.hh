@@ -0,0 +1,45 @@
+#ifndef HEADLESSVIDEOSYSTEM_HH
+#define HEADLESSVIDEOSYSTEM_HH
+
+#include "VideoSystem.hh"
+#include "components.hh"
+#include <memory>
+
+namespace openmsx {
+
+class Reactor;
+class Display;
+class OutputSurface;
+
+/** Video system that renders MSX frames without ever showing them.
+  * The VDPs get a normal PixelRenderer and rasterizer, so RawFrames are
+  * produced (e.g. to calculate frame hashes or take raw screenshots), but
+  * there is no window and nothing is ever painted or scaled.
+  */
+class HeadlessVideoSystem final : public VideoSystem
+{
+public:
+	explicit HeadlessVideoSystem(Reactor& reactor);
+	~HeadlessVideoSystem() override;
+
+	// VideoSystem interface:
+	std::unique_ptr<Rasterizer> createRasterizer(VDP& vdp) override;
+	std::unique_ptr<V9990Rasterizer> createV9990Rasterizer(
+		V9990& vdp) override;
+#if COMPONENT_LASERDISC
+	std::unique_ptr<LDRasterizer> createLDRasterizer(
+		LaserdiscPlayer& ld) override;
+#endif
+	void flush() override;
+	OutputSurface* getOutputSurface() override;
+
+private:
+	Display& display;
+	/** In-memory surface, only used to determine the pixel format of
+	  * the rendered frames. Never painted on. */
+	std::unique_ptr<OutputSurface> screen;
+};
+
+} // namespace openmsx
+
+#endif
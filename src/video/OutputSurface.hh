@@ -8,6 +8,8 @@
 
 namespace openmsx {
 
+namespace PNG { struct SaveOptions; }
+
 /** A frame buffer where pixels can be written to.
   * It could be an in-memory buffer or a video buffer visible to the user
   * (see VisibleSurface subclass).
@@ -126,7 +128,8 @@ public:
 	/** Save the content of this OutputSurface to a PNG file.
 	  * @throws MSXException If creating the PNG file fails.
 	  */
-	virtual void saveScreenshot(const std::string& filename) = 0;
+	virtual void saveScreenshot(const std::string& filename,
+	                            const PNG::SaveOptions& options) = 0;
 
 	/** Clear screen (paint it black).
 	 */
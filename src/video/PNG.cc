@@ -294,8 +294,21 @@ static void flushData(png_structp ctx)
 	file->flush();
 }
 
+static int getPNGFilter(SaveOptions::Filter filter)
+{
+	switch (filter) {
+		case SaveOptions::FILTER_NONE:  return PNG_FILTER_NONE;
+		case SaveOptions::FILTER_SUB:   return PNG_FILTER_SUB;
+		case SaveOptions::FILTER_UP:    return PNG_FILTER_UP;
+		case SaveOptions::FILTER_AVG:   return PNG_FILTER_AVG;
+		case SaveOptions::FILTER_PAETH: return PNG_FILTER_PAETH;
+		default:                        return PNG_ALL_FILTERS;
+	}
+}
+
 static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
-                           const std::string& filename, bool color)
+                           const std::string& filename, bool color,
+                           const SaveOptions& options)
 {
 	try {
 		File file(filename, File::TRUNCATE);
@@ -349,6 +362,15 @@ static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
 					PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
 					PNG_FILTER_TYPE_BASE);
 
+		// Speed/size trade-off, doesn't change the image itself.
+		if (options.compressionLevel >= 0) {
+			png_set_compression_level(png.ptr, options.compressionLevel);
+		}
+		if (options.filter != SaveOptions::FILTER_DEFAULT) {
+			png_set_filter(png.ptr, PNG_FILTER_TYPE_BASE,
+			               getPNGFilter(options.filter));
+		}
+
 		// Write the file header information.  REQUIRED
 		png_write_info(png.ptr, png.info);
 
@@ -364,7 +386,20 @@ static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
 	}
 }
 
-static void save(SDL_Surface* image, const std::string& filename)
+static void saveOrQueue(unsigned width, unsigned height,
+                        const void** rowPointers, bool color,
+                        const std::string& filename, const SaveOptions& options)
+{
+	if (options.asyncWriter) {
+		options.asyncWriter->push(width, height, rowPointers, color,
+		                          filename, options);
+	} else {
+		IMG_SavePNG_RW(width, height, rowPointers, filename, color, options);
+	}
+}
+
+static void save(SDL_Surface* image, const std::string& filename,
+                 const SaveOptions& options)
 {
 	SDLAllocFormatPtr frmt24(SDL_AllocFormat(
 		OPENMSX_BIGENDIAN ? SDL_PIXELFORMAT_BGR24 : SDL_PIXELFORMAT_RGB24));
@@ -376,11 +411,12 @@ static void save(SDL_Surface* image, const std::string& filename)
 		row_pointers[i] = surf24.getLinePtr(i);
 	}
 
-	IMG_SavePNG_RW(image->w, image->h, row_pointers, filename, true);
+	saveOrQueue(image->w, image->h, row_pointers, true, filename, options);
 }
 
 void save(unsigned width, unsigned height, const void** rowPointers,
-          const SDL_PixelFormat& format, const std::string& filename)
+          const SDL_PixelFormat& format, const std::string& filename,
+          const SaveOptions& options)
 {
 	// this implementation creates 1 extra copy, can be optimized if required
 	SDLSurfacePtr surface(
@@ -390,19 +426,117 @@ void save(unsigned width, unsigned height, const void** rowPointers,
 		memcpy(surface.getLinePtr(y),
 		       rowPointers[y], width * format.BytesPerPixel);
 	}
-	save(surface.get(), filename);
+	save(surface.get(), filename, options);
+}
+
+void save(unsigned width, unsigned height, const void** rowPointers,
+          const std::string& filename, const SaveOptions& options)
+{
+	saveOrQueue(width, height, rowPointers, true, filename, options);
+}
+
+void saveGrayscale(unsigned width, unsigned height, const void** rowPointers,
+                   const std::string& filename, const SaveOptions& options)
+{
+	saveOrQueue(width, height, rowPointers, false, filename, options);
+}
+
+
+// class AsyncWriter
+
+AsyncWriter::AsyncWriter(std::function<void()> notify_)
+	: notify(std::move(notify_))
+	, thread([this]() { run(); })
+{
+}
+
+AsyncWriter::~AsyncWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	jobCond.notify_all();
+	thread.join();
 }
 
-void save(unsigned width, unsigned height,
-          const void** rowPointers, const std::string& filename)
+void AsyncWriter::push(unsigned width, unsigned height,
+                       const void** rowPointers, bool color,
+                       const std::string& filename, const SaveOptions& options)
 {
-	IMG_SavePNG_RW(width, height, rowPointers, filename, true);
+	// Create the (still empty) file right away. The name is often picked
+	// with getNextNumberedFileName(), which only looks at existing files,
+	// so this reserves it for the next screenshot. It also reports e.g.
+	// a non-writable directory immediately.
+	{ File file(filename, File::TRUNCATE); }
+
+	Job job;
+	unsigned lineSize = width * (color ? 3 : 1);
+	job.pixels.resize(lineSize * height);
+	for (unsigned y = 0; y < height; ++y) {
+		memcpy(&job.pixels[y * lineSize], rowPointers[y], lineSize);
+	}
+	job.filename = filename;
+	job.options = options;
+	job.options.asyncWriter = nullptr;
+	job.width = width;
+	job.height = height;
+	job.color = color;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobCond.notify_one();
 }
 
-void saveGrayscale(unsigned width, unsigned height,
-                   const void** rowPointers, const std::string& filename)
+void AsyncWriter::flush()
 {
-	IMG_SavePNG_RW(width, height, rowPointers, filename, false);
+	std::unique_lock<std::mutex> lock(mutex);
+	doneCond.wait(lock, [&]() { return jobs.empty() && (busy == 0); });
+}
+
+std::vector<std::string> AsyncWriter::takeErrors()
+{
+	std::vector<std::string> result;
+	std::lock_guard<std::mutex> lock(mutex);
+	swap(result, errors);
+	return result;
+}
+
+void AsyncWriter::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		jobCond.wait(lock, [&]() { return quit || !jobs.empty(); });
+		if (jobs.empty()) break; // quit, but only once all jobs are done
+
+		Job job = std::move(jobs.front());
+		jobs.pop_front();
+		++busy;
+		lock.unlock();
+
+		std::string error;
+		unsigned lineSize = job.width * (job.color ? 3 : 1);
+		VLA(const void*, rowPointers, job.height);
+		for (unsigned y = 0; y < job.height; ++y) {
+			rowPointers[y] = &job.pixels[y * lineSize];
+		}
+		try {
+			IMG_SavePNG_RW(job.width, job.height, rowPointers,
+			               job.filename, job.color, job.options);
+		} catch (MSXException& e) {
+			error = e.getMessage();
+		}
+
+		lock.lock();
+		--busy;
+		if (!error.empty()) errors.push_back(std::move(error));
+		if (jobs.empty() && (busy == 0)) doneCond.notify_all();
+		lock.unlock();
+		if (notify) notify();
+		lock.lock();
+	}
+	doneCond.notify_all();
 }
 
 } // namespace PNG
@@ -2,7 +2,14 @@
 #define PNG_HH
 
 #include "SDLSurfacePtr.hh"
+#include "MemBuffer.hh"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 struct SDL_PixelFormat;
 
@@ -11,6 +18,26 @@ namespace openmsx {
 /** Utility functions to hide the complexity of saving to a PNG file.
   */
 namespace PNG {
+	class AsyncWriter;
+
+	/** Parameters for writing a PNG file. These trade encoding speed
+	  * for file size, the resulting image is always the same.
+	  */
+	struct SaveOptions {
+		/** zlib compression level, 0 (store only) up to 9 (smallest
+		  * file), or -1 for the zlib default. */
+		int compressionLevel = -1;
+		/** Row filter strategy. FILTER_DEFAULT lets libpng pick a
+		  * filter per row (slowest), the others force one filter. */
+		enum Filter {
+			FILTER_DEFAULT, FILTER_NONE, FILTER_SUB,
+			FILTER_UP, FILTER_AVG, FILTER_PAETH
+		} filter = FILTER_DEFAULT;
+		/** When not nullptr, the image is copied and encoded on this
+		  * writer's thread, save() then returns immediately. */
+		AsyncWriter* asyncWriter = nullptr;
+	};
+
 	/** Load the given PNG file in a SDL_Surface.
 	 * This SDL_Surface is either 24bpp or 32bpp, depending on whether the
 	 * PNG file had an alpha layer. But it's possible to force a 32bpp
@@ -20,11 +47,60 @@ namespace PNG {
 	SDLSurfacePtr load(const std::string& filename, bool want32bpp);
 
 	void save(unsigned width, unsigned height, const void** rowPointers,
-	          const SDL_PixelFormat& format, const std::string& filename);
+	          const SDL_PixelFormat& format, const std::string& filename,
+	          const SaveOptions& options = {});
 	void save(unsigned width, unsigned height, const void** rowPointers,
-	          const std::string& filename);
+	          const std::string& filename, const SaveOptions& options = {});
 	void saveGrayscale(unsigned width, unsigned height,
-	                   const void** rowPointers, const std::string& filename);
+	                   const void** rowPointers, const std::string& filename,
+	                   const SaveOptions& options = {});
+
+	/** Encodes and writes PNG files on a background thread.
+	 * Errors can't be reported to the caller of save() anymore. Instead
+	 * the 'notify' callback is invoked (on the writer thread) after each
+	 * written file, the messages of failed writes can then be fetched
+	 * with takeErrors().
+	 */
+	class AsyncWriter
+	{
+	public:
+		explicit AsyncWriter(std::function<void()> notify);
+		/** Writes all pending files before returning. */
+		~AsyncWriter();
+
+		/** Queue an image, the pixel data is copied. The (empty) file
+		  * is already created before this returns.
+		  * @throw MSXException When the file can't be created. */
+		void push(unsigned width, unsigned height,
+		          const void** rowPointers, bool color,
+		          const std::string& filename, const SaveOptions& options);
+
+		/** Block until all queued images are written. */
+		void flush();
+
+		std::vector<std::string> takeErrors();
+
+	private:
+		struct Job {
+			MemBuffer<uint8_t> pixels;
+			std::string filename;
+			SaveOptions options;
+			unsigned width;
+			unsigned height;
+			bool color;
+		};
+		void run();
+
+		std::function<void()> notify;
+		std::deque<Job> jobs;
+		std::vector<std::string> errors;
+		std::mutex mutex;
+		std::condition_variable jobCond;  // new job or quit
+		std::condition_variable doneCond; // queue became empty
+		unsigned busy = 0; // number of jobs being encoded right now
+		bool quit = false;
+		std::thread thread;
+	};
 
 } // namespace PNG
 } // namespace openmsx
@@ -0,0 +1,264 @@
+#ifndef PATTERNEXPAND_HH
+#define PATTERNEXPAND_HH
+
+#include "openmsx.hh"
+#include <cassert>
+#include <cstdint>
+#ifdef __SSE2__
+#include "emmintrin.h" // SSE2
+#endif
+#ifdef __AVX2__
+#include "immintrin.h" // AVX2
+#endif
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace openmsx {
+
+/** Whole-line kernels that expand 1bpp pattern bytes to host pixels.
+  *
+  * A set bit in a pattern byte selects the foreground color, a reset bit
+  * the background color, bit 7 is the leftmost pixel. Each pattern byte
+  * produces 8 host pixels. The character renderers first gather the
+  * patterns (and colors) of a complete display line and then hand them
+  * to one of these kernels, so the expansion itself runs branch-free over
+  * (at least) 32 pixels per loop iteration.
+  */
+namespace PatternExpand {
+
+// Lanes<Pixel> abstracts a group of 8 pixels:
+//   splat(p)    all 8 lanes equal to 'p'
+//   mask(pat)   all-ones in the lanes whose pattern bit is set
+//   sel(m,a,b)  per lane 'm ? a : b'
+//   store(o,v)  unaligned store of 8 pixels
+
+template<typename Pixel> struct Lanes
+{
+	// Generic C++ version.
+	struct V { Pixel p[8]; };
+	static inline V splat(Pixel x) {
+		V r; for (int i = 0; i < 8; ++i) r.p[i] = x; return r;
+	}
+	static inline V mask(byte pat) {
+		V r;
+		for (int i = 0; i < 8; ++i) r.p[i] = (pat & (0x80 >> i)) ? Pixel(~0) : 0;
+		return r;
+	}
+	static inline V sel(const V& m, const V& a, const V& b) {
+		V r;
+		for (int i = 0; i < 8; ++i) r.p[i] = b.p[i] ^ ((a.p[i] ^ b.p[i]) & m.p[i]);
+		return r;
+	}
+	static inline void store(Pixel* out, const V& v) {
+		for (int i = 0; i < 8; ++i) out[i] = v.p[i];
+	}
+};
+
+#if defined(__AVX2__)
+// 32bpp: one character is exactly one 256-bit register.
+template<> struct Lanes<uint32_t>
+{
+	using V = __m256i;
+	static inline V splat(uint32_t x) { return _mm256_set1_epi32(x); }
+	static inline V mask(byte pat) {
+		const __m256i bits = _mm256_set_epi32(
+			0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+		__m256i p = _mm256_set1_epi32(pat);
+		return _mm256_cmpeq_epi32(_mm256_and_si256(p, bits), bits);
+	}
+	static inline V sel(V m, V a, V b) { return _mm256_blendv_epi8(b, a, m); }
+	static inline void store(uint32_t* out, V v) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+	}
+};
+#elif defined(__SSE2__)
+template<> struct Lanes<uint32_t>
+{
+	struct V { __m128i lo, hi; };
+	static inline V splat(uint32_t x) {
+		__m128i t = _mm_set1_epi32(x); return {t, t};
+	}
+	static inline V mask(byte pat) {
+		const __m128i b74 = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+		const __m128i b30 = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+		__m128i p = _mm_set1_epi32(pat);
+		return {_mm_cmpeq_epi32(_mm_and_si128(p, b74), b74),
+		        _mm_cmpeq_epi32(_mm_and_si128(p, b30), b30)};
+	}
+	static inline __m128i sel1(__m128i m, __m128i a, __m128i b) {
+		return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a, b), m), b);
+	}
+	static inline V sel(const V& m, const V& a, const V& b) {
+		return {sel1(m.lo, a.lo, b.lo), sel1(m.hi, a.hi, b.hi)};
+	}
+	static inline void store(uint32_t* out, const V& v) {
+		auto* o = reinterpret_cast<__m128i*>(out);
+		_mm_storeu_si128(o + 0, v.lo);
+		_mm_storeu_si128(o + 1, v.hi);
+	}
+};
+#elif defined(__ARM_NEON)
+template<> struct Lanes<uint32_t>
+{
+	using V = uint32x4x2_t;
+	static inline V splat(uint32_t x) {
+		uint32x4_t t = vdupq_n_u32(x); return {{t, t}};
+	}
+	static inline V mask(byte pat) {
+		static const uint32_t b[8] = {
+			0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+		uint32x4_t p = vdupq_n_u32(pat);
+		return {{vtstq_u32(p, vld1q_u32(b + 0)),
+		         vtstq_u32(p, vld1q_u32(b + 4))}};
+	}
+	static inline V sel(const V& m, const V& a, const V& b) {
+		return {{vbslq_u32(m.val[0], a.val[0], b.val[0]),
+		         vbslq_u32(m.val[1], a.val[1], b.val[1])}};
+	}
+	static inline void store(uint32_t* out, const V& v) {
+		vst1q_u32(out + 0, v.val[0]);
+		vst1q_u32(out + 4, v.val[1]);
+	}
+};
+#endif
+
+#if defined(__SSE2__)
+// 16bpp: one character is exactly one 128-bit register.
+template<> struct Lanes<uint16_t>
+{
+	using V = __m128i;
+	static inline V splat(uint16_t x) { return _mm_set1_epi16(x); }
+	static inline V mask(byte pat) {
+		const __m128i bits = _mm_set_epi16(
+			0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+		__m128i p = _mm_set1_epi16(pat);
+		return _mm_cmpeq_epi16(_mm_and_si128(p, bits), bits);
+	}
+	static inline V sel(V m, V a, V b) {
+		return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a, b), m), b);
+	}
+	static inline void store(uint16_t* out, V v) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+	}
+};
+#elif defined(__ARM_NEON)
+template<> struct Lanes<uint16_t>
+{
+	using V = uint16x8_t;
+	static inline V splat(uint16_t x) { return vdupq_n_u16(x); }
+	static inline V mask(byte pat) {
+		static const uint16_t b[8] = {
+			0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+		return vtstq_u16(vdupq_n_u16(pat), vld1q_u16(b));
+	}
+	static inline V sel(V m, V a, V b) { return vbslq_u16(m, a, b); }
+	static inline void store(uint16_t* out, V v) { vst1q_u16(out, v); }
+};
+#endif
+
+
+/** Expand a single pattern byte to 8 pixels.
+  */
+template<typename Pixel>
+inline void draw8(Pixel* __restrict out, Pixel fg, Pixel bg, byte pattern)
+{
+	using L = Lanes<Pixel>;
+	L::store(out, L::sel(L::mask(pattern), L::splat(fg), L::splat(bg)));
+}
+
+/** Expand 'num' pattern bytes that all use the same fg/bg color pair.
+  * Writes 8 * num pixels.
+  */
+template<typename Pixel>
+inline void mono(Pixel* __restrict out, const byte* __restrict patterns,
+                 unsigned num, Pixel fg, Pixel bg)
+{
+	using L = Lanes<Pixel>;
+	auto fgV = L::splat(fg);
+	auto bgV = L::splat(bg);
+	unsigned i = 0;
+	for (; (i + 4) <= num; i += 4) {
+		L::store(out +  0, L::sel(L::mask(patterns[i + 0]), fgV, bgV));
+		L::store(out +  8, L::sel(L::mask(patterns[i + 1]), fgV, bgV));
+		L::store(out + 16, L::sel(L::mask(patterns[i + 2]), fgV, bgV));
+		L::store(out + 24, L::sel(L::mask(patterns[i + 3]), fgV, bgV));
+		out += 32;
+	}
+	for (; i < num; ++i) {
+		L::store(out, L::sel(L::mask(patterns[i]), fgV, bgV));
+		out += 8;
+	}
+}
+
+/** Expand 'num' pattern bytes, each with its own fg/bg color pair.
+  * Writes 8 * num pixels.
+  */
+template<typename Pixel>
+inline void color(Pixel* __restrict out, const byte* __restrict patterns,
+                  const Pixel* __restrict fgs, const Pixel* __restrict bgs,
+                  unsigned num)
+{
+	using L = Lanes<Pixel>;
+	unsigned i = 0;
+	for (; (i + 4) <= num; i += 4) {
+		for (unsigned j = 0; j < 4; ++j) {
+			L::store(out, L::sel(L::mask(patterns[i + j]),
+			                     L::splat(fgs[i + j]),
+			                     L::splat(bgs[i + j])));
+			out += 8;
+		}
+	}
+	for (; i < num; ++i) {
+		L::store(out, L::sel(L::mask(patterns[i]),
+		                     L::splat(fgs[i]), L::splat(bgs[i])));
+		out += 8;
+	}
+}
+
+/** Expand 'num' pattern bytes where a second bit stream 'selects' picks,
+  * per pixel, between the color pairs (fg0, bg0) and (fg1, bg1). This is
+  * used for the blink attribute in Text2 mode.
+  * Writes 8 * num pixels.
+  */
+template<typename Pixel>
+inline void blink(Pixel* __restrict out, const byte* __restrict patterns,
+                  const byte* __restrict selects, unsigned num,
+                  Pixel fg0, Pixel bg0, Pixel fg1, Pixel bg1)
+{
+	using L = Lanes<Pixel>;
+	auto fg0V = L::splat(fg0); auto bg0V = L::splat(bg0);
+	auto fg1V = L::splat(fg1); auto bg1V = L::splat(bg1);
+	for (unsigned i = 0; i < num; ++i) {
+		auto s = L::mask(selects[i]);
+		auto fgV = L::sel(s, fg1V, fg0V);
+		auto bgV = L::sel(s, bg1V, bg0V);
+		L::store(out, L::sel(L::mask(patterns[i]), fgV, bgV));
+		out += 8;
+	}
+}
+
+/** Pack 'num' 6-pixel wide patterns (the upper 6 bits of each input byte)
+  * into a contiguous bit stream of (num * 6 / 8) bytes, so that text mode
+  * lines can be expanded with the 8-pixel kernels above.
+  * @pre num is a multiple of 4.
+  */
+inline void pack6(byte* __restrict out, const byte* __restrict in, unsigned num)
+{
+	assert((num % 4) == 0);
+	for (unsigned i = 0; i < num; i += 4) {
+		unsigned bits = ((in[i + 0] & 0xFC) << 16) |
+		                ((in[i + 1] & 0xFC) << 10) |
+		                ((in[i + 2] & 0xFC) <<  4) |
+		                ((in[i + 3] & 0xFC) >>  2);
+		out[0] = bits >> 16;
+		out[1] = bits >>  8;
+		out[2] = bits >>  0;
+		out += 3;
+	}
+}
+
+} // namespace PatternExpand
+} // namespace openmsx
+
+#endif
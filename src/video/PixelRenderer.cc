@@ -176,7 +176,8 @@ void PixelRenderer::frameStart(EmuTime::param time)
 			renderFrame = true;
 		} else {
 			++frameSkipCounter;
-			if (rasterizer->isRecording()) {
+			if (rasterizer->isRecording() ||
+			    renderSettings.getFrameHash()) {
 				renderFrame = true;
 			} else {
 				renderFrame = realTime.timeLeft(
@@ -407,8 +408,9 @@ inline bool PixelRenderer::checkSync(int offset, EmuTime::param time)
 	// TODO: Because range is entire VRAM, offset == address.
 
 	// If display is disabled, VRAM changes will not affect the
-	// renderer output, therefore sync is not necessary.
-	// TODO: Have bitmapVisibleWindow disabled in this case.
+	// renderer output, therefore sync is not necessary. (VDPVRAM also
+	// disables the bitmapVisibleWindow in this case, so usually we don't
+	// even get here.)
 	if (!displayEnabled) return false;
 	//if (frameSkipCounter != 0) return false; // TODO
 	if (accuracy == RenderSettings::ACC_SCREEN) return false;
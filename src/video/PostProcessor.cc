@@ -16,6 +16,7 @@
 #include "FinishFrameEvent.hh"
 #include "CommandException.hh"
 #include "MemBuffer.hh"
+#include "strCat.hh"
 #include "vla.hh"
 #include "likely.hh"
 #include "build-info.hh"
@@ -33,15 +34,19 @@ PostProcessor::PostProcessor(MSXMotherBoard& motherBoard_,
 	, Schedulable(motherBoard_.getScheduler())
 	, renderSettings(display_.getRenderSettings())
 	, screen(screen_)
+	, framePool(screen_.getSDLFormat(), maxWidth_, height_)
 	, paintFrame(nullptr)
 	, recorder(nullptr)
 	, superImposeVideoFrame(nullptr)
 	, superImposeVdpFrame(nullptr)
 	, interleaveCount(0)
 	, lastFramesCount(0)
-	, maxWidth(maxWidth_)
 	, height(height_)
 	, display(display_)
+	, msxCliComm(motherBoard_.getMSXCliComm())
+	, videoSourceName(videoSource)
+	, frameHash(0)
+	, frameHashCount(0)
 	, canDoInterlace(canDoInterlace_)
 	, lastRotate(motherBoard_.getCurrentTime())
 	, eventDistributor(motherBoard_.getReactor().getEventDistributor())
@@ -55,6 +60,8 @@ PostProcessor::PostProcessor(MSXMotherBoard& motherBoard_,
 			screen.getSDLFormat(), lastFrames);
 		superImposedFrame = SuperImposedFrame::create(
 			screen.getSDLFormat());
+		// Don't allocate while emulating the first frame.
+		framePool.reserve(1);
 	} else {
 		// Laserdisc always produces non-interlaced frames, so we don't
 		// need lastFrames[1..3], deinterlacedFrame and
@@ -134,10 +141,18 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 	                   lastFrames + recycleIdx + 1);
 	lastFrames[0] = std::move(finishedFrame);
 
+	if (renderSettings.getFrameHash()) {
+		hashFrame(*lastFrames[0]);
+	}
+
 	// Are enough frames available?
 	if (lastFramesCount >= numRequired) {
-		// Only the last 'numRequired' are kept up to date.
+		// Only the last 'numRequired' are kept up to date, the older
+		// ones are unused until e.g. deflicker gets enabled again.
 		lastFramesCount = numRequired;
+		for (int i = numRequired; i < 4; ++i) {
+			framePool.release(std::move(lastFrames[i]));
+		}
 	} else {
 		// Not enough past frames, fall back to 'regular' rendering.
 		// This situation can only occur when:
@@ -194,8 +209,7 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 	// Return recycled frame to the caller
 	if (canDoInterlace) {
 		if (unlikely(!recycleFrame)) {
-			recycleFrame = std::make_unique<RawFrame>(
-				screen.getSDLFormat(), maxWidth, height);
+			recycleFrame = framePool.acquire();
 		}
 		return recycleFrame;
 	} else {
@@ -203,6 +217,14 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 	}
 }
 
+void PostProcessor::hashFrame(const RawFrame& frame)
+{
+	frameHash = frame.calcHash();
+	++frameHashCount;
+	msxCliComm.update(CliComm::FRAMEHASH, videoSourceName,
+	                  strCat(frameHashCount, ' ', hex_string<8>(frameHash)));
+}
+
 void PostProcessor::executeUntil(EmuTime::param /*time*/)
 {
 	// insert fake end of frame event
@@ -211,22 +233,19 @@ void PostProcessor::executeUntil(EmuTime::param /*time*/)
 			getVideoSource(), getVideoSourceSetting(), false));
 }
 
-using WorkBuffer = std::vector<MemBuffer<char, SSE2_ALIGNMENT>>;
+using WorkBuffer = MemBuffer<char, SSE2_ALIGNMENT>;
 static void getScaledFrame(FrameSource& paintFrame, unsigned bpp,
                            unsigned height, const void** lines,
                            WorkBuffer& workBuffer)
 {
 	unsigned width = (height == 240) ? 320 : 640;
 	unsigned pitch = width * ((bpp == 32) ? 4 : 2);
-	const void* line = nullptr;
-	void* work = nullptr;
+	// One allocation for the whole frame, lines that are available
+	// directly in the source frame leave their part of it unused.
+	workBuffer.resize(height * pitch);
 	for (unsigned i = 0; i < height; ++i) {
-		if (line == work) {
-			// If work buffer was used in previous iteration,
-			// then allocate a new one.
-			workBuffer.emplace_back(pitch);
-			work = workBuffer.back().data();
-		}
+		void* work = workBuffer.data() + i * pitch;
+		const void* line = nullptr;
 #if HAVE_32BPP
 		if (bpp == 32) {
 			// 32bpp
@@ -255,7 +274,8 @@ static void getScaledFrame(FrameSource& paintFrame, unsigned bpp,
 	}
 }
 
-void PostProcessor::takeRawScreenShot(unsigned height2, const std::string& filename)
+void PostProcessor::takeRawScreenShot(unsigned height2, const std::string& filename,
+                                      const PNG::SaveOptions& options)
 {
 	if (!paintFrame) {
 		throw CommandException("TODO");
@@ -265,7 +285,8 @@ void PostProcessor::takeRawScreenShot(unsigned height2, const std::string& filen
 	WorkBuffer workBuffer;
 	getScaledFrame(*paintFrame, getBpp(), height2, lines, workBuffer);
 	unsigned width = (height2 == 240) ? 320 : 640;
-	PNG::save(width, height2, lines, paintFrame->getSDLPixelFormat(), filename);
+	PNG::save(width, height2, lines, paintFrame->getSDLPixelFormat(), filename,
+	          options);
 }
 
 unsigned PostProcessor::getBpp() const
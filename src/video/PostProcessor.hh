@@ -2,11 +2,14 @@
 #define POSTPROCESSOR_HH
 
 #include "FrameSource.hh"
+#include "RawFramePool.hh"
 #include "VideoLayer.hh"
 #include "Schedulable.hh"
 #include "EmuTime.hh"
 #include <memory>
+#include <string>
 #include <vector>
+#include <cstdint>
 
 namespace openmsx {
 
@@ -87,8 +90,20 @@ public:
 	  */
 	FrameSource* getPaintFrame() const { return paintFrame; }
 
+	/** Hash of the most recently finished frame. Only calculated while
+	  * the "frame_hash" setting is enabled.
+	  * @see RawFrame::calcHash()
+	  */
+	uint32_t getFrameHash() const { return frameHash; }
+
+	/** Number of frames that were hashed so far (this is also the number
+	  * of the frame that getFrameHash() belongs to).
+	  */
+	uint64_t getFrameHashCount() const { return frameHashCount; }
+
 	// VideoLayer
-	void takeRawScreenShot(unsigned height, const std::string& filename) override;
+	void takeRawScreenShot(unsigned height, const std::string& filename,
+	                       const PNG::SaveOptions& options) override;
 
 
 	CliComm& getCliComm();
@@ -112,6 +127,10 @@ protected:
 	/** The last 4 fully rendered (unscaled) MSX frames. */
 	std::unique_ptr<RawFrame> lastFrames[4];
 
+	/** Frames that are currently not in lastFrames[] nor in use by the
+	  * rasterizer. */
+	RawFramePool framePool;
+
 	/** Combined the last two frames in a deinterlaced frame. */
 	std::unique_ptr<DeinterlacedFrame> deinterlacedFrame;
 
@@ -140,14 +159,21 @@ protected:
 
 	int interleaveCount; // for interleave-black-frame
 	int lastFramesCount; // How many items in lastFrames[] are up-to-date
-	int maxWidth; // we lazily create RawFrame objects in lastFrames[]
-	int height;   // these two vars remember how big those should be
+	int height; // height of the RawFrame objects in lastFrames[]
 
 private:
 	// Schedulable
 	void executeUntil(EmuTime::param time) override;
 
+	/** Hash the just finished frame and report it via CliComm. */
+	void hashFrame(const RawFrame& frame);
+
 	Display& display;
+	CliComm& msxCliComm;
+	const std::string videoSourceName;
+
+	uint32_t frameHash;
+	uint64_t frameHashCount;
 
 	/** Laserdisc cannot do interlace (better: the current implementation
 	  * is not interlaced). In that case some internal stuff can be done
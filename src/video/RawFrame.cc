@@ -1,4 +1,5 @@
 #include "RawFrame.hh"
+#include "xxhash.hh"
 #include <cstdint>
 #include <SDL.h>
 
@@ -52,6 +53,20 @@ unsigned RawFrame::getRowLength() const
 	return maxWidth; // in pixels (not in bytes)
 }
 
+uint32_t RawFrame::calcHash() const
+{
+	unsigned bytesPerPixel = getSDLPixelFormat().BytesPerPixel;
+	uint32_t hash = 0;
+	for (unsigned line = 0; line < getHeight(); ++line) {
+		unsigned width = lineWidths[line];
+		uint32_t lineHash = xxhash(string_view(
+			data.data() + line * pitch, width * bytesPerPixel));
+		hash = (hash ^ lineHash) * 2654435761u;
+		hash = (hash << 13) | (hash >> 19);
+	}
+	return hash;
+}
+
 bool RawFrame::hasContiguousStorage() const
 {
 	return true;
@@ -52,6 +52,13 @@ public:
 
 	unsigned getRowLength() const override;
 
+	/** Calculate a (non-cryptographic) hash of the content of this frame.
+	  * Only the visible part of each line (see getLineWidthDirect()) is
+	  * taken into account, so the result only depends on the emulated
+	  * image and the pixel format.
+	  */
+	uint32_t calcHash() const;
+
 	// RawFrame is mostly agnostic of the border info struct. The only
 	// thing it does is store the information and give access to it.
 	V9958RasterizerBorderInfo& getBorderInfo() { return borderInfo; }
@@ -0,0 +1,36 @@
+#include "RawFramePool.hh"
+
+namespace openmsx {
+
+RawFramePool::RawFramePool(const SDL_PixelFormat& format_,
+                           unsigned maxWidth_, unsigned height_)
+	: format(format_)
+	, maxWidth(maxWidth_)
+	, height(height_)
+{
+}
+
+std::unique_ptr<RawFrame> RawFramePool::acquire()
+{
+	if (freeFrames.empty()) {
+		return std::make_unique<RawFrame>(format, maxWidth, height);
+	}
+	auto result = std::move(freeFrames.back());
+	freeFrames.pop_back();
+	return result;
+}
+
+void RawFramePool::release(std::unique_ptr<RawFrame> frame)
+{
+	if (frame) freeFrames.push_back(std::move(frame));
+}
+
+void RawFramePool::reserve(unsigned num)
+{
+	while (freeFrames.size() < num) {
+		freeFrames.push_back(
+			std::make_unique<RawFrame>(format, maxWidth, height));
+	}
+}
+
+} // namespace openmsx
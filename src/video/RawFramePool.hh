@@ -0,0 +1,43 @@
+#ifndef RAWFRAMEPOOL_HH
+#define RAWFRAMEPOOL_HH
+
+#include "RawFrame.hh"
+#include <memory>
+#include <vector>
+
+namespace openmsx {
+
+/** A free-list of RawFrame objects that all have the same pixel format and
+  * dimensions. Allocating a RawFrame is expensive (a frame is up to 1MB),
+  * so frames that are (temporarily) no longer needed are handed back to
+  * the pool and reused for the next request, instead of being freed and
+  * allocated again.
+  */
+class RawFramePool
+{
+public:
+	RawFramePool(const SDL_PixelFormat& format,
+	             unsigned maxWidth, unsigned height);
+
+	/** Get a frame from the pool, only allocates when the pool is empty.
+	  * The content of the returned frame is unspecified.
+	  */
+	std::unique_ptr<RawFrame> acquire();
+
+	/** Hand a frame back to the pool. It's allowed to pass nullptr. */
+	void release(std::unique_ptr<RawFrame> frame);
+
+	/** Make sure at least 'num' frames can be acquired without
+	  * allocating. */
+	void reserve(unsigned num);
+
+private:
+	std::vector<std::unique_ptr<RawFrame>> freeFrames;
+	const SDL_PixelFormat& format;
+	const unsigned maxWidth;
+	const unsigned height;
+};
+
+} // namespace openmsx
+
+#endif
@@ -38,6 +38,7 @@ EnumSetting<RenderSettings::RendererID>::Map RenderSettings::getRendererMap()
 {
 	EnumSetting<RendererID>::Map rendererMap = {
 		{ "none", DUMMY },// TODO: only register when in CliComm mode
+		{ "headless", HEADLESS },
 		{ "SDL", SDL } };
 #if COMPONENT_GL
 	// compiled with OpenGL-2.0, still need to test whether
@@ -185,6 +186,13 @@ RenderSettings::RenderSettings(CommandController& commandController)
 		"Useful on (100Hz+) lightboost enabled monitors to reduce "
 		"motion blur and double frame artifacts.",
 		false)
+
+	, frameHashSetting(commandController,
+		"frame_hash",
+		"Calculate a hash of each rendered MSX frame, see "
+		"'openmsx_info frame_hash' and the 'framehash' update. "
+		"While enabled no frames are skipped.",
+		false, Setting::DONT_SAVE)
 {
 	brightnessSetting.attach(*this);
 	contrastSetting  .attach(*this);
@@ -218,8 +226,10 @@ RenderSettings::RenderSettings(CommandController& commandController)
 	//   save renderer=none
 	rendererSetting.setDontSaveValue(TclObject("none"));
 
-	// A saved value 'none' can be very confusing. If so change it to default.
-	if (rendererSetting.getEnum() == DUMMY) {
+	// A saved value 'none' (or 'headless') can be very confusing. If so
+	// change it to default.
+	if ((rendererSetting.getEnum() == DUMMY) ||
+	    (rendererSetting.getEnum() == HEADLESS)) {
 		rendererSetting.setValue(rendererSetting.getDefaultValue());
 	}
 	// set saved value as default
@@ -24,7 +24,7 @@ public:
 	/** Enumeration of Renderers known to openMSX.
 	  * This is the full list, the list of available renderers may be smaller.
 	  */
-	enum RendererID { UNINITIALIZED, DUMMY, SDL,
+	enum RendererID { UNINITIALIZED, DUMMY, HEADLESS, SDL,
 	                  SDLGL_PP, SDLGL_FB16, SDLGL_FB32 };
 	using RendererSetting = EnumSetting<RendererID>;
 
@@ -169,6 +169,10 @@ public:
 		return interleaveBlackFrameSetting.getBoolean();
 	}
 
+	/** Calculate a hash of each rendered MSX frame?
+	  * When enabled, frames are never skipped. */
+	bool getFrameHash() const { return frameHashSetting.getBoolean(); }
+
 	/** Apply brightness, contrast and gamma transformation on the input
 	  * color component. The component is expected to be in the range
 	  * [0.0 .. 1.0] but it's not an error if it lays outside of this range.
@@ -225,6 +229,7 @@ private:
 	FloatSetting horizontalStretchSetting;
 	FloatSetting pointerHideDelaySetting;
 	BooleanSetting interleaveBlackFrameSetting;
+	BooleanSetting frameHashSetting;
 
 	float brightness;
 	float contrast;
@@ -9,6 +9,7 @@
 // Video systems:
 #include "components.hh"
 #include "DummyVideoSystem.hh"
+#include "HeadlessVideoSystem.hh"
 #include "SDLVideoSystem.hh"
 
 // Renderers:
@@ -33,6 +34,8 @@ unique_ptr<VideoSystem> createVideoSystem(Reactor& reactor)
 	switch (display.getRenderSettings().getRenderer()) {
 		case RenderSettings::DUMMY:
 			return std::make_unique<DummyVideoSystem>();
+		case RenderSettings::HEADLESS:
+			return std::make_unique<HeadlessVideoSystem>(reactor);
 		case RenderSettings::SDL:
 		case RenderSettings::SDLGL_PP:
 		case RenderSettings::SDLGL_FB16:
@@ -49,6 +52,7 @@ unique_ptr<Renderer> createRenderer(VDP& vdp, Display& display)
 	switch (display.getRenderSettings().getRenderer()) {
 		case RenderSettings::DUMMY:
 			return std::make_unique<DummyRenderer>();
+		case RenderSettings::HEADLESS:
 		case RenderSettings::SDL:
 		case RenderSettings::SDLGL_PP:
 		case RenderSettings::SDLGL_FB16:
@@ -64,6 +68,7 @@ unique_ptr<V9990Renderer> createV9990Renderer(V9990& vdp, Display& display)
 	switch (display.getRenderSettings().getRenderer()) {
 		case RenderSettings::DUMMY:
 			return std::make_unique<V9990DummyRenderer>();
+		case RenderSettings::HEADLESS:
 		case RenderSettings::SDL:
 		case RenderSettings::SDLGL_PP:
 		case RenderSettings::SDLGL_FB16:
@@ -80,6 +85,7 @@ unique_ptr<LDRenderer> createLDRenderer(LaserdiscPlayer& ld, Display& display)
 	switch (display.getRenderSettings().getRenderer()) {
 		case RenderSettings::DUMMY:
 			return std::make_unique<LDDummyRenderer>();
+		case RenderSettings::HEADLESS:
 		case RenderSettings::SDL:
 		case RenderSettings::SDLGL_PP:
 		case RenderSettings::SDLGL_FB16:
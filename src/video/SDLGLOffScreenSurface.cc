@@ -38,9 +38,11 @@ void SDLGLOffScreenSurface::clearScreen()
 	SDLGLOutputSurface::clearScreen();
 }
 
-void SDLGLOffScreenSurface::saveScreenshot(const std::string& filename)
+void SDLGLOffScreenSurface::saveScreenshot(
+	const std::string& filename, const PNG::SaveOptions& options)
 {
-	SDLGLOutputSurface::saveScreenshot(filename, getWidth(), getHeight());
+	SDLGLOutputSurface::saveScreenshot(
+		filename, getWidth(), getHeight(), options);
 }
 
 } // namespace openmsx
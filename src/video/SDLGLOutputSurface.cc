@@ -104,7 +104,8 @@ void SDLGLOutputSurface::clearScreen()
 }
 
 void SDLGLOutputSurface::saveScreenshot(
-	const std::string& filename, unsigned width, unsigned height)
+	const std::string& filename, unsigned width, unsigned height,
+	const PNG::SaveOptions& options)
 {
 	VLA(const void*, rowPointers, height);
 	MemBuffer<uint8_t> buffer(width * height * 3);
@@ -112,7 +113,7 @@ void SDLGLOutputSurface::saveScreenshot(
 		rowPointers[height - 1 - i] = &buffer[width * 3 * i];
 	}
 	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, buffer.data());
-	PNG::save(width, height, rowPointers, filename);
+	PNG::save(width, height, rowPointers, filename, options);
 }
 
 } // namespace openmsx
@@ -8,6 +8,7 @@
 namespace openmsx {
 
 class OutputSurface;
+namespace PNG { struct SaveOptions; }
 
 /** This is a common base class for SDLGLVisibleSurface and
   * SDLGLOffScreenSurface. It's only purpose is to have a place to put common
@@ -31,7 +32,8 @@ protected:
 	void flushFrameBuffer(unsigned width, unsigned height);
 	void clearScreen();
 	void saveScreenshot(const std::string& filename,
-	                    unsigned width, unsigned height);
+	                    unsigned width, unsigned height,
+	                    const PNG::SaveOptions& options);
 
 private:
 	float texCoordX, texCoordY;
@@ -98,9 +98,11 @@ void SDLGLVisibleSurface::clearScreen()
 	SDLGLOutputSurface::clearScreen();
 }
 
-void SDLGLVisibleSurface::saveScreenshot(const std::string& filename)
+void SDLGLVisibleSurface::saveScreenshot(
+	const std::string& filename, const PNG::SaveOptions& options)
 {
-	SDLGLOutputSurface::saveScreenshot(filename, getWidth(), getHeight());
+	SDLGLOutputSurface::saveScreenshot(
+		filename, getWidth(), getHeight(), options);
 }
 
 void SDLGLVisibleSurface::finish()
@@ -14,7 +14,8 @@ public:
 
 private:
 	// OutputSurface
-	void saveScreenshot(const std::string& filename) override;
+	void saveScreenshot(const std::string& filename,
+	                    const PNG::SaveOptions& options) override;
 	void clearScreen() override;
 
 	MemBuffer<char, SSE2_ALIGNMENT> buffer;
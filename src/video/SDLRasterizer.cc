@@ -10,7 +10,7 @@
 #include "FloatSetting.hh"
 #include "StringSetting.hh"
 #include "MemoryOps.hh"
-#include "VisibleSurface.hh"
+#include "OutputSurface.hh"
 #include "build-info.hh"
 #include "components.hh"
 #include <algorithm>
@@ -72,7 +72,7 @@ inline void SDLRasterizer<Pixel>::renderBitmapLine(Pixel* buf, unsigned vramLine
 
 template <class Pixel>
 SDLRasterizer<Pixel>::SDLRasterizer(
-		VDP& vdp_, Display& display, VisibleSurface& screen_,
+		VDP& vdp_, Display& display, OutputSurface& screen_,
 		std::unique_ptr<PostProcessor> postProcessor_)
 	: vdp(vdp_), vram(vdp.getVRAM())
 	, screen(screen_)
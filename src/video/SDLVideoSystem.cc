@@ -236,11 +236,12 @@ void SDLVideoSystem::flush()
 	screen->finish();
 }
 
-void SDLVideoSystem::takeScreenShot(const std::string& filename, bool withOsd)
+void SDLVideoSystem::takeScreenShot(const std::string& filename, bool withOsd,
+                                    const PNG::SaveOptions& options)
 {
 	if (withOsd) {
 		// we can directly save current content as screenshot
-		screen->saveScreenshot(filename);
+		screen->saveScreenshot(filename, options);
 	} else {
 		// we first need to re-render to an off-screen surface
 		// with OSD layers disabled
@@ -248,7 +249,7 @@ void SDLVideoSystem::takeScreenShot(const std::string& filename, bool withOsd)
 		ScopedLayerHider hideOsd(*osdGuiLayer);
 		std::unique_ptr<OutputSurface> surf = screen->createOffScreenSurface();
 		display.repaint(*surf);
-		surf->saveScreenshot(filename);
+		surf->saveScreenshot(filename, options);
 	}
 }
 
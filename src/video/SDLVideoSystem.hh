@@ -40,7 +40,8 @@ public:
 #endif
 	bool checkSettings() override;
 	void flush() override;
-	void takeScreenShot(const std::string& filename, bool withOsd) override;
+	void takeScreenShot(const std::string& filename, bool withOsd,
+	                    const PNG::SaveOptions& options) override;
 	void updateWindowTitle() override;
 	OutputSurface* getOutputSurface() override;
 
@@ -81,13 +81,15 @@ std::unique_ptr<OutputSurface> SDLVisibleSurface::createOffScreenSurface()
 	return std::make_unique<SDLOffScreenSurface>(*getSDLSurface());
 }
 
-void SDLVisibleSurface::saveScreenshot(const std::string& filename)
+void SDLVisibleSurface::saveScreenshot(
+	const std::string& filename, const PNG::SaveOptions& options)
 {
-	saveScreenshotSDL(*this, filename);
+	saveScreenshotSDL(*this, filename, options);
 }
 
 void SDLVisibleSurface::saveScreenshotSDL(
-	OutputSurface& output, const std::string& filename)
+	OutputSurface& output, const std::string& filename,
+	const PNG::SaveOptions& options)
 {
 	unsigned width = output.getWidth();
 	unsigned height = output.getHeight();
@@ -101,7 +103,7 @@ void SDLVisibleSurface::saveScreenshotSDL(
 			SDL_PIXELFORMAT_RGB24, buffer.data(), width * 3)) {
 		throw MSXException("Couldn't acquire screenshot pixels: ", SDL_GetError());
 	}
-	PNG::save(width, height, rowPointers, filename);
+	PNG::save(width, height, rowPointers, filename, options);
 }
 
 void SDLVisibleSurface::clearScreen()
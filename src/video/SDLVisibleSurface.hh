@@ -16,11 +16,13 @@ public:
 	                  CliComm& cliComm);
 
 	static void saveScreenshotSDL(OutputSurface& output,
-	                              const std::string& filename);
+	                              const std::string& filename,
+	                              const PNG::SaveOptions& options);
 
 private:
 	// OutputSurface
-	void saveScreenshot(const std::string& filename) override;
+	void saveScreenshot(const std::string& filename,
+	                    const PNG::SaveOptions& options) override;
 	void clearScreen() override;
 
 	// VisibleSurface
@@ -22,6 +22,7 @@ SpriteChecker::SpriteChecker(VDP& vdp_, RenderSettings& renderSettings,
 	: vdp(vdp_), vram(vdp.getVRAM())
 	, limitSpritesSetting(renderSettings.getLimitSpritesSetting())
 	, frameStartTime(time)
+	, numSprites(0), spriteLinesMagSize(-1), spriteLinesDirty(true)
 {
 	vram.spriteAttribTable.setObserver(this);
 	vram.spritePatternTable.setObserver(this);
@@ -32,6 +33,7 @@ void SpriteChecker::reset(EmuTime::param time)
 	vdp.setSpriteStatus(0); // TODO 0x00 or 0x1F  (blueMSX has 0x1F)
 	collisionX = 0;
 	collisionY = 0;
+	spriteLinesDirty = true;
 
 	frameStart(time);
 
@@ -78,6 +80,73 @@ inline SpriteChecker::SpritePattern SpriteChecker::calculatePatternPlanar(
 	return !vdp.isSpriteMag() ? pattern : doublePattern(pattern);
 }
 
+inline void SpriteChecker::updateSpriteLines(
+	const byte* attribY, int stride, int terminator, int magSize)
+{
+	if (!spriteLinesDirty && (magSize == spriteLinesMagSize)) return;
+	spriteLinesDirty = false;
+
+	byte newY[32];
+	int num = 0;
+	for (/**/; num < 32; ++num) {
+		byte y = attribY[stride * num];
+		if (y == terminator) break;
+		newY[num] = y;
+	}
+	if ((num == numSprites) && (magSize == spriteLinesMagSize) &&
+	    std::equal(newY, newY + num, spriteY)) {
+		// Only patterns or other sprite attributes changed.
+		return;
+	}
+
+	numSprites = num;
+	spriteLinesMagSize = magSize;
+	std::copy(newY, newY + num, spriteY);
+	ranges::fill(spriteLineMask, 0);
+	for (int sprite = 0; sprite < num; ++sprite) {
+		for (int i = 0; i < magSize; ++i) {
+			spriteLineMask[(spriteY[sprite] + i) & 0xFF] |= 1u << sprite;
+		}
+	}
+}
+
+// Find the leftmost pixel in the visible area [0, 256) that is covered by
+// at least two of the given sprites. Sprites that have any of the bits in
+// 'ignoreAttrib' set in their color attribute don't take part.
+// Returns the X coordinate of that pixel, or -1 if there is no collision.
+static int findCollision(const SpriteChecker::SpriteInfo* sprites, int num,
+                         byte ignoreAttrib)
+{
+	// One bit per pixel, 32 pixels per word, the leftmost pixel in the
+	// most significant bit (just like SpritePattern). Word 0 covers the
+	// pixels [-32, 0), word 9 the pixels [256, 288), so sprites that are
+	// partially outside the visible area need no special treatment. Each
+	// sprite touches at most 2 words, so the cost is independent of the
+	// number of sprite pairs.
+	uint32_t covered[10] = {};
+	uint32_t collision[10] = {};
+	for (int i = 0; i < num; ++i) {
+		if (sprites[i].colorAttrib & ignoreAttrib) continue;
+		int x = sprites[i].x + 32;
+		assert((0 <= x) && (x < 32 * 9));
+		int w = x / 32;
+		int s = x % 32;
+		SpriteChecker::SpritePattern pattern = sprites[i].pattern;
+		uint32_t left  = pattern >> s;
+		uint32_t right = s ? (pattern << (32 - s)) : 0;
+		collision[w + 0] |= covered[w + 0] & left;
+		collision[w + 1] |= covered[w + 1] & right;
+		covered[w + 0] |= left;
+		covered[w + 1] |= right;
+	}
+	for (int w = 1; w < 9; ++w) {
+		if (collision[w]) {
+			return 32 * (w - 1) + Math::countLeadingZeros(collision[w]);
+		}
+	}
+	return -1;
+}
+
 void SpriteChecker::updateSprites1(int limit)
 {
 	if (vdp.spritesEnabledFast()) {
@@ -97,21 +166,14 @@ void SpriteChecker::updateSprites1(int limit)
 
 inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 {
-	// This implementation contains a double for-loop. The outer loop goes
-	// over the sprites, the inner loop over the to-be-checked lines. This
-	// is not the order in which the real VDP performs this operation: the
-	// real VDP renders line-per-line and for each line checks all 32
-	// sprites.
-	//
-	// Though this 'reverse' order allows to skip over very large regions
-	// of the inner loop: we only have to process the lines were a
-	// particular sprite is actually visible. I measured this makes this
-	// routine 4x-5x faster!
-	//
-	// This routine also needs to detect the sprite number of the 'first'
-	// 5th-sprite-condition. With 'first' meaning the first line where this
-	// condition occurs. Because our loops are swapped compared to the real
-	// VDP, we need some extra fixup logic to correctly detect this.
+	// Like the real VDP this goes line-per-line over the to-be-checked
+	// lines, but instead of testing all 32 sprites on each line, it only
+	// visits the sprites that are visible on that line. Those are looked
+	// up in 'spriteLineMask', which only has to be recalculated when the
+	// Y coordinates in the sprite attribute table (or the sprite size)
+	// change. Usually this happens at most a few times per frame, while
+	// this routine is called many times per frame (for a few lines each
+	// time).
 
 	// Calculate display line.
 	// This is the line sprites are checked at; the line they are displayed
@@ -128,20 +190,16 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	int fifthSpriteNum  = -1;  // no 5th sprite detected yet
 	int fifthSpriteLine = 999; // larger than any possible valid line
 
-	int sprite = 0;
-	for (/**/; sprite < 32; ++sprite) {
-		int y = attributePtr[4 * sprite + 0];
-		if (y == 208) break;
+	updateSpriteLines(attributePtr, 4, 208, magSize);
 
-		for (int line = minLine; line < maxLine; ++line) {
+	for (int line = minLine; line < maxLine; ++line) {
+		int displayLine = line + displayDelta;
+		uint32_t mask = spriteLineMask[displayLine & 0xFF];
+		while (mask) {
+			int sprite = Math::findFirstSet(mask) - 1;
+			mask &= mask - 1;
 			// Calculate line number within the sprite.
-			int displayLine = line + displayDelta;
-			int spriteLine = (displayLine - y) & 0xFF;
-			if (spriteLine >= magSize) {
-				// Skip ahead till sprite becomes visible.
-				line += 256 - spriteLine - 1; // -1 because of for-loop
-				continue;
-			}
+			int spriteLine = (displayLine - spriteY[sprite]) & 0xFF;
 
 			int visibleIndex = spriteCount[line];
 			if (visibleIndex == 4) {
@@ -150,7 +208,9 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 					fifthSpriteLine = line;
 					fifthSpriteNum = sprite;
 				}
-				if (limitSprites) continue;
+				// All following sprites on this line are
+				// dropped as well.
+				if (limitSprites) break;
 			}
 
 			SpriteInfo& sip = spriteBuffer[line][visibleIndex];
@@ -178,7 +238,7 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	}
 	if (~status & 0x40) {
 		// No 5th sprite detected, store number of latest sprite processed.
-		status = (status & 0x20) | std::min(sprite, 31);
+		status = (status & 0x20) | std::min(numSprites, 31);
 	}
 	vdp.setSpriteStatus(status);
 
@@ -200,41 +260,14 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow,
-	but there are max 4 sprites and therefore max 6 pairs.
-	If any collision is found, method returns at once.
+	Implemented with a bitmask of the covered pixels per line, see
+	findCollision(). If any collision is found, method returns at once.
 	*/
 	for (int line = minLine; line < maxLine; ++line) {
-		int minXCollision = 999;
-		for (int i = std::min<int>(4, spriteCount[line]); --i >= 1; /**/) {
-			int x_i = spriteBuffer[line][i].x;
-			SpritePattern pattern_i = spriteBuffer[line][i].pattern;
-			for (int j = i; --j >= 0; ) {
-				// Do sprite i and sprite j collide?
-				int x_j = spriteBuffer[line][j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = spriteBuffer[line][j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + Math::countLeadingZeros(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
+		int count = std::min<int>(4, spriteCount[line]);
+		if (count < 2) continue;
+		int minXCollision = findCollision(spriteBuffer[line], count, 0x00);
+		if (minXCollision >= 0) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// verified: collision coords are also filled
 			//           in for sprite mode 1
@@ -267,7 +300,7 @@ void SpriteChecker::updateSprites2(int limit)
 
 inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 {
-	// See comment in checkSprites1() about order of inner and outer loops.
+	// See comment in checkSprites1() about 'spriteLineMask'.
 
 	// Calculate display line.
 	// This is the line sprites are checked at; the line they are displayed
@@ -285,26 +318,21 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 
 	// Because it gave a measurable performance boost, we duplicated the
 	// code for planar and non-planar modes.
-	int sprite = 0;
 	if (planar) {
 		const byte* attributePtr0;
 		const byte* attributePtr1;
 		vram.spriteAttribTable.getReadAreaPlanar(
 			512, 32 * 4, attributePtr0, attributePtr1);
+		updateSpriteLines(attributePtr0, 2, 216, magSize);
 		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[2 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) {
+		for (int line = minLine; line < maxLine; ++line) {
+			int displayLine = line + displayDelta;
+			uint32_t mask = spriteLineMask[displayLine & 0xFF];
+			while (mask) {
+				int sprite = Math::findFirstSet(mask) - 1;
+				mask &= mask - 1;
 				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
+				int spriteLine = (displayLine - spriteY[sprite]) & 0xFF;
 
 				int visibleIndex = spriteCount[line];
 				if (visibleIndex == 8) {
@@ -313,7 +341,7 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 						ninthSpriteLine = line;
 						ninthSpriteNum = sprite;
 					}
-					if (limitSprites) continue;
+					if (limitSprites) break;
 				}
 
 				if (mag) spriteLine /= 2;
@@ -336,20 +364,16 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	} else {
 		const byte* attributePtr0 =
 			vram.spriteAttribTable.getReadArea(512, 32 * 4);
+		updateSpriteLines(attributePtr0, 4, 216, magSize);
 		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[4 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) {
+		for (int line = minLine; line < maxLine; ++line) {
+			int displayLine = line + displayDelta;
+			uint32_t mask = spriteLineMask[displayLine & 0xFF];
+			while (mask) {
+				int sprite = Math::findFirstSet(mask) - 1;
+				mask &= mask - 1;
 				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
+				int spriteLine = (displayLine - spriteY[sprite]) & 0xFF;
 
 				int visibleIndex = spriteCount[line];
 				if (visibleIndex == 8) {
@@ -358,7 +382,7 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 						ninthSpriteLine = line;
 						ninthSpriteNum = sprite;
 					}
-					if (limitSprites) continue;
+					if (limitSprites) break;
 				}
 
 				if (mag) spriteLine /= 2;
@@ -405,7 +429,7 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	}
 	if (~status & 0x40) {
 		// No 9th sprite detected, store number of latest sprite processed.
-		status = (status & 0x20) | std::min(sprite, 31);
+		status = (status & 0x20) | std::min(numSprites, 31);
 	}
 	vdp.setSpriteStatus(status);
 
@@ -428,49 +452,14 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow.
-	There are max 8 sprites and therefore max 42 pairs.
-	  TODO: Maybe this is slow... Think of something faster.
-	        Probably new approach is needed anyway for OR-ing.
+	Implemented with a bitmask of the covered pixels per line, see
+	findCollision(). Sprites with CC or IC set cannot collide.
 	*/
 	for (int line = minLine; line < maxLine; ++line) {
-		int minXCollision = 999; // no collision
-		SpriteInfo* visibleSprites = spriteBuffer[line];
-		for (int i = std::min<int>(8, spriteCount[line]); --i >= 1; /**/) {
-			// If CC or IC is set, this sprite cannot collide.
-			if (visibleSprites[i].colorAttrib & 0x60) continue;
-
-			int x_i = visibleSprites[i].x;
-			SpritePattern pattern_i = visibleSprites[i].pattern;
-			for (int j = i; --j >= 0; ) {
-				// If CC or IC is set, this sprite cannot collide.
-				if (visibleSprites[j].colorAttrib & 0x60) continue;
-
-				// Do sprite i and sprite j collide?
-				int x_j = visibleSprites[j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = visibleSprites[j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + Math::countLeadingZeros(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
+		int count = std::min<int>(8, spriteCount[line]);
+		if (count < 2) continue;
+		int minXCollision = findCollision(spriteBuffer[line], count, 0x60);
+		if (minXCollision >= 0) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// x-coord should be increased by 12
 			// y-coord                         8
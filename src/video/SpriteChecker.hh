@@ -240,10 +240,12 @@ public:
 
 	void updateVRAM(unsigned /*offset*/, EmuTime::param time) override {
 		checkUntil(time);
+		spriteLinesDirty = true;
 	}
 
 	void updateWindow(bool /*enabled*/, EmuTime::param time) override {
 		sync(time);
+		spriteLinesDirty = true;
 	}
 
 	template<typename Archive>
@@ -253,6 +255,7 @@ private:
 	/** Calculate 'updateSpritesMethod' and 'planar'.
 	  */
 	inline void setDisplayMode(DisplayMode mode) {
+		spriteLinesDirty = true;
 		switch (mode.getSpriteMode(vdp.isMSX1VDP())) {
 		case 0:
 			updateSpritesMethod = nullptr;
@@ -290,6 +293,19 @@ private:
 	inline SpritePattern calculatePatternNP(unsigned patternNr, unsigned y);
 	inline SpritePattern calculatePatternPlanar(unsigned patternNr, unsigned y);
 
+	/** Make sure 'spriteLineMask', 'spriteY' and 'numSprites' match the
+	  * current content of the sprite attribute table and the current
+	  * sprite size. They are only recalculated when the Y coordinates
+	  * (or the size) actually changed since the last call.
+	  * @param attribY Pointer to the Y coordinate of sprite 0.
+	  * @param stride Distance between the Y coordinates of two sprites.
+	  * @param terminator Y value that disables this and all following
+	  *                   sprites (208 in sprite mode 1, 216 in mode 2).
+	  * @param magSize Sprite height, corrected for magnification.
+	  */
+	inline void updateSpriteLines(const byte* attribY, int stride,
+	                              int terminator, int magSize);
+
 	/** Check sprite collision and number of sprites per line.
 	  * This routine implements sprite mode 1 (MSX1).
 	  * Separated from display code to make MSX behaviour consistent
@@ -365,6 +381,32 @@ private:
 	  */
 	uint8_t spriteCount[313];
 
+	/** For each display line (modulo 256) a bitmask of the sprites
+	  * that are visible on that line: bit N is set for sprite N.
+	  * This only depends on the Y coordinates in the sprite attribute
+	  * table and the sprite size, not on the vertical scroll register.
+	  */
+	uint32_t spriteLineMask[256];
+
+	/** The Y coordinates (of the first 'numSprites' sprites) from which
+	  * 'spriteLineMask' was calculated.
+	  */
+	byte spriteY[32];
+
+	/** Number of sprites before the terminating Y coordinate.
+	  */
+	int numSprites;
+
+	/** Sprite height (corrected for magnification) for which
+	  * 'spriteLineMask' was calculated.
+	  */
+	int spriteLinesMagSize;
+
+	/** Set when the sprite tables (may) have changed since the last time
+	  * 'spriteLineMask' was validated.
+	  */
+	bool spriteLinesDirty;
+
 	/** Is current display mode planar or not?
 	  * TODO: Introduce separate update methods for planar/nonplanar modes.
 	  */
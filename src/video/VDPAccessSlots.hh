@@ -83,7 +83,7 @@ private:
 	int ticks;
 	int limit;
 	VDP::VDPClock ref;
-	const uint8_t* const tab;
+	const uint8_t* tab;
 };
 
 /** Return the time of the next available access slot that is at least 'delta'
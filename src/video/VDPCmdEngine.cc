@@ -151,6 +151,24 @@ static inline unsigned clipNY_2(unsigned SY, unsigned DY, unsigned NY, byte ARG)
 //using IncrShift6 = IncrShift4;
 
 
+/** Advance 'calculator' over the VRAM accesses of one row of 'num' bytes of
+  * a HMMV/HMMM/YMMM command, ending at the time of the last write. When
+  * 'readDelta' is not DELTA_0 each write is preceded by a read, that
+  * many cycles earlier. 'writeDelta' is the distance between a write and
+  * the next read (or write).
+  * @return true iff the complete row is executed before the limit.
+  */
+static inline bool rowEndBeforeLimit(
+	Calculator& calculator, unsigned num, Delta readDelta, Delta writeDelta)
+{
+	for (unsigned i = 1; i < num; ++i) {
+		if (readDelta != DELTA_0) calculator.next(readDelta);
+		calculator.next(writeDelta);
+	}
+	if (readDelta != DELTA_0) calculator.next(readDelta);
+	return !calculator.limitReached();
+}
+
 template<typename LogOp> static void psetFast(
 	EmuTime::param time, VDPVRAM& vram, unsigned addr,
 	byte color, byte mask, LogOp op)
@@ -1342,6 +1360,29 @@ void VDPCmdEngine::executeHmmv(EmuTime::param limit)
 	bool doPset = !dstExt || hasExtendedVRAM;
 	auto calculator = getSlotCalculator(limit);
 
+	// Fast path: complete rows that are finished before 'limit' and that
+	// no VRAM observer is interested in are written in one go. Nothing
+	// else can access VRAM before 'limit', only the timing still needs to
+	// be calculated per byte.
+	const unsigned rowMask = Mode::addressOf(~0u, 0, false);
+	while (likely(!dstExt) && (ANX == tmpNX) &&
+	       !vram.isObservedBlock(Mode::addressOf(ADX, DY, false), rowMask)) {
+		auto rowEnd = calculator;
+		if (!rowEndBeforeLimit(rowEnd, ANX, DELTA_0, DELTA_48)) break;
+		for (unsigned i = 0; i < ANX; ++i, ADX += TX) {
+			vram.cmdWriteUnobserved(Mode::addressOf(ADX, DY, false), COL);
+		}
+		calculator = rowEnd;
+		DY += TY; --NY;
+		ADX = DX;
+		if (--tmpNY == 0) {
+			commandDone(calculator.getTime());
+			engineTime = calculator.getTime();
+			return;
+		}
+		calculator.next(DELTA_104);
+	}
+
 	while (!calculator.limitReached()) {
 		if (likely(doPset)) {
 			vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
@@ -1450,6 +1491,30 @@ void VDPCmdEngine::executeHmmm(EmuTime::param limit)
 	bool doPset  = !dstExt || hasExtendedVRAM;
 	auto calculator = getSlotCalculator(limit);
 
+	// Fast path, see executeHmmv(). Source and destination may overlap,
+	// so keep the byte-by-byte read-before-write order.
+	const unsigned rowMask = Mode::addressOf(~0u, 0, false);
+	while (likely(!srcExt && !dstExt) && (phase == 0) && (ANX == tmpNX) &&
+	       !vram.isObservedBlock(Mode::addressOf(ADX, DY, false), rowMask)) {
+		auto rowEnd = calculator;
+		if (!rowEndBeforeLimit(rowEnd, ANX, DELTA_24, DELTA_64)) break;
+		for (unsigned i = 0; i < ANX; ++i, ASX += TX, ADX += TX) {
+			vram.cmdWriteUnobserved(
+				Mode::addressOf(ADX, DY, false),
+				vram.cmdReadWindow.readNP(
+					Mode::addressOf(ASX, SY, false)));
+		}
+		calculator = rowEnd;
+		SY += TY; DY += TY; --NY;
+		ASX = SX; ADX = DX;
+		if (--tmpNY == 0) {
+			commandDone(calculator.getTime());
+			engineTime = calculator.getTime();
+			return;
+		}
+		calculator.next(DELTA_128);
+	}
+
 	switch (phase) {
 	case 0:
 loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
@@ -1584,6 +1649,30 @@ void VDPCmdEngine::executeYmmm(EmuTime::param limit)
 	bool doPset  = !dstExt || hasExtendedVRAM;
 	auto calculator = getSlotCalculator(limit);
 
+	// Fast path, see executeHmmv().
+	const unsigned rowMask = Mode::addressOf(~0u, 0, false);
+	while (likely(!dstExt) && (phase == 0) && (ANX == tmpNX) &&
+	       !vram.isObservedBlock(Mode::addressOf(ADX, DY, false), rowMask)) {
+		auto rowEnd = calculator;
+		if (!rowEndBeforeLimit(rowEnd, ANX, DELTA_24, DELTA_40)) break;
+		for (unsigned i = 0; i < ANX; ++i, ADX += TX) {
+			vram.cmdWriteUnobserved(
+				Mode::addressOf(ADX, DY, false),
+				vram.cmdReadWindow.readNP(
+					Mode::addressOf(ADX, SY, false)));
+		}
+		calculator = rowEnd;
+		SY += TY; DY += TY; --NY;
+		ADX = DX;
+		if (--tmpNY == 0) {
+			commandDone(calculator.getTime());
+			engineTime = calculator.getTime();
+			return;
+		}
+		// note: going to the next line does not take extra time
+		calculator.next(DELTA_40);
+	}
+
 	switch (phase) {
 	case 0:
 loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
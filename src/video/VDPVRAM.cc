@@ -13,8 +13,9 @@ namespace openmsx {
 
 DummyVRAMOBserver VRAMWindow::dummyObserver;
 
-VRAMWindow::VRAMWindow(Ram& vram)
+VRAMWindow::VRAMWindow(Ram& vram, bool& windowsChanged_)
 	: data(&vram[0])
+	, windowsChanged(windowsChanged_)
 {
 	observer = &dummyObserver;
 	baseAddr  = -1; // disable window
@@ -116,15 +117,16 @@ VDPVRAM::VDPVRAM(VDP& vdp_, unsigned size, EmuTime::param time)
 	, vramTime(EmuTime::zero)
 	#endif
 	, actualSize(size)
-	, cmdReadWindow(data)
-	, cmdWriteWindow(data)
-	, nameTable(data)
-	, colorTable(data)
-	, patternTable(data)
-	, bitmapVisibleWindow(data)
-	, bitmapCacheWindow(data)
-	, spriteAttribTable(data)
-	, spritePatternTable(data)
+	, windowsChanged(true)
+	, cmdReadWindow      (data, windowsChanged)
+	, cmdWriteWindow     (data, windowsChanged)
+	, nameTable          (data, windowsChanged)
+	, colorTable         (data, windowsChanged)
+	, patternTable       (data, windowsChanged)
+	, bitmapVisibleWindow(data, windowsChanged)
+	, bitmapCacheWindow  (data, windowsChanged)
+	, spriteAttribTable  (data, windowsChanged)
+	, spritePatternTable (data, windowsChanged)
 {
 	(void)time;
 
@@ -164,6 +166,15 @@ void VDPVRAM::updateDisplayEnabled(bool enabled, EmuTime::param time)
 	cmdEngine->sync(time);
 	renderer->updateDisplayEnabled(enabled, time);
 	spriteChecker->updateDisplayEnabled(enabled, time);
+
+	// While the display is disabled, the renderer output doesn't depend
+	// on the VRAM content. Disabling the window allows VRAM writes to
+	// skip the renderer (see VDPVRAM::observedBlocks).
+	if (enabled) {
+		bitmapVisibleWindow.setMask(0x1FFFF, ~0u << 17, time);
+	} else {
+		bitmapVisibleWindow.disable(time);
+	}
 }
 
 void VDPVRAM::updateSpritesEnabled(bool enabled, EmuTime::param time)
@@ -174,6 +185,21 @@ void VDPVRAM::updateSpritesEnabled(bool enabled, EmuTime::param time)
 	spriteChecker->updateSpritesEnabled(enabled, time);
 }
 
+void VDPVRAM::updateObservedBlocks()
+{
+	windowsChanged = false;
+	for (auto& b : observedBlocks) b = 0;
+	const unsigned AREA_MASK = OBSERVED_BLOCK_SIZE - 1;
+	for (unsigned block = 0; block < 0x40000 / OBSERVED_BLOCK_SIZE; ++block) {
+		unsigned address = block * OBSERVED_BLOCK_SIZE;
+		if (bitmapVisibleWindow.isObservedBlock(address, AREA_MASK) ||
+		    spriteAttribTable  .isObservedBlock(address, AREA_MASK) ||
+		    spritePatternTable .isObservedBlock(address, AREA_MASK)) {
+			observedBlocks[block / 32] |= 1u << (block % 32);
+		}
+	}
+}
+
 void VDPVRAM::setSizeMask(EmuTime::param time)
 {
 	sizeMask = (
@@ -211,6 +237,8 @@ void VDPVRAM::updateVRMode(bool newVRmode, EmuTime::param time)
 	}
 	vrMode = newVRmode;
 	setSizeMask(time);
+	// The sprite checker caches (info derived from) the attribute table.
+	spriteAttribTable.notifyAll(time);
 
 	if (vrMode) {
 		// switch from VR=0 to VR=1
@@ -238,7 +266,7 @@ void VDPVRAM::setRenderer(Renderer* newRenderer, EmuTime::param time)
 	bitmapVisibleWindow.setObserver(renderer);
 }
 
-void VDPVRAM::change4k8kMapping(bool mapping8k)
+void VDPVRAM::change4k8kMapping(bool mapping8k, EmuTime::param time)
 {
 	/* Sources:
 	 *  - http://www.msx.org/forumtopicl8624.html
@@ -282,6 +310,8 @@ void VDPVRAM::change4k8kMapping(bool mapping8k)
 	 * even in 4K mode, all 16K of VRAM can be accessed. The only
 	 * difference is in what addresses are used to store data.
 	 */
+	spriteAttribTable.notifyAll(time);
+
 	byte tmp[0x4000];
 	if (mapping8k) {
 		// from 8k/16k to 4k mapping
@@ -317,6 +347,7 @@ void VRAMWindow::serialize(Archive& ar, unsigned /*version*/)
 	if (ar.isLoader()) {
 		effectiveBaseMask = origBaseMask & sizeMask;
 		combiMask = ~effectiveBaseMask | indexMask;
+		windowsChanged = true;
 		// TODO ?  observer->updateWindow(isEnabled(), time);
 	}
 }
@@ -341,6 +372,15 @@ void VDPVRAM::serialize(Archive& ar, unsigned /*version*/)
 	ar.serialize("bitmapCacheWindow",   bitmapCacheWindow);
 	ar.serialize("spriteAttribTable",   spriteAttribTable);
 	ar.serialize("spritePatternTable",  spritePatternTable);
+
+	if (ar.isLoader()) {
+		// Older versions kept this window always enabled. Enabling it
+		// is always safe, it gets disabled again at the next display
+		// disable (e.g. at the start of the bottom border).
+		bitmapVisibleWindow.setMask(
+			0x1FFFF, ~0u << 17,
+			static_cast<MSXDevice&>(vdp).getCurrentTime());
+	}
 }
 INSTANTIATE_SERIALIZE_METHODS(VDPVRAM);
 
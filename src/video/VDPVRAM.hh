@@ -10,6 +10,7 @@
 #include "openmsx.hh"
 #include "likely.hh"
 #include <cassert>
+#include <cstdint>
 
 namespace openmsx {
 
@@ -174,6 +175,7 @@ public:
 		indexMask         = newIndexMask;
 		baseAddr  =  effectiveBaseMask & indexMask; // this enables window
 		combiMask = ~effectiveBaseMask | indexMask;
+		windowsChanged = true;
 	}
 
 	/** Disable this window: no address will be considered inside.
@@ -182,6 +184,7 @@ public:
 	inline void disable(EmuTime::param time) {
 		observer->updateWindow(false, time);
 		baseAddr = -1;
+		windowsChanged = true;
 	}
 
 	/** Is the given index range continuous in VRAM (iow there's no mirroring)
@@ -278,12 +281,14 @@ public:
 	  */
 	inline void setObserver(VRAMObserver* newObserver) {
 		observer = newObserver;
+		windowsChanged = true;
 	}
 
 	/** Unregister the observer of this VRAM window.
 	  */
 	inline void resetObserver() {
 		observer = &dummyObserver;
+		windowsChanged = true;
 	}
 
 	/** Test whether an address is inside this window.
@@ -297,6 +302,17 @@ public:
 		return (address & combiMask) == unsigned(baseAddr);
 	}
 
+	/** Is there an observer that (possibly) needs to be notified for a
+	  * write to one of the addresses in the aligned block
+	  *   (address & ~areaMask) | x   with 'x' any subset of 'areaMask'.
+	  * This check is conservative: it may return true even if no address
+	  * of the block is actually inside this window.
+	  */
+	inline bool isObservedBlock(unsigned address, unsigned areaMask) const {
+		return hasObserver() && isEnabled() &&
+		       (((address ^ unsigned(baseAddr)) & combiMask & ~areaMask) == 0);
+	}
+
 	/** Notifies the observer of this window of a VRAM change,
 	  * if the changes address is inside this window.
 	  * @param address The address to test.
@@ -308,6 +324,17 @@ public:
 		}
 	}
 
+	/** Inform the observer that (possibly) all bytes in this window will
+	  * change at once, for example because the VRAM gets remapped.
+	  * Like updateVRAM(), this must be called before the change.
+	  * @param time The moment in emulated time the change occurs.
+	  */
+	inline void notifyAll(EmuTime::param time) {
+		if (isEnabled()) {
+			observer->updateWindow(true, time);
+		}
+	}
+
 	/** Inform VRAMWindow of changed sizeMask.
 	  * For the moment this only happens when switching the VR bit in VDP
 	  * register 8 (in VR=0 mode only 32kB VRAM is addressable).
@@ -333,13 +360,20 @@ private:
 
 	/** Create a new window.
 	  * Initially, the window is disabled; use setRange to enable it.
+	  * @param vram The VRAM data.
+	  * @param windowsChanged Flag that is set whenever the mask or the
+	  *     observer of this window changes, see VDPVRAM::observedBlocks.
 	  */
-	explicit VRAMWindow(Ram& vram);
+	VRAMWindow(Ram& vram, bool& windowsChanged);
 
 	/** Pointer to the entire VRAM data.
 	  */
 	byte* data;
 
+	/** Flag in VDPVRAM, shared by all its windows.
+	  */
+	bool& windowsChanged;
+
 	/** Observer associated with this VRAM window.
 	  * It will be called when changes occur within the window.
 	  * If there is no observer, this variable is &dummyObserver.
@@ -428,6 +462,30 @@ public:
 		writeCommon(address, value, time);
 	}
 
+	/** Does any VRAM observer (renderer, sprite checker) need to be
+	  * notified when the command engine writes somewhere in the aligned
+	  * block described by 'address' and 'areaMask'? See
+	  * VRAMWindow::isObservedBlock(). When not, the block can be written
+	  * with cmdWriteUnobserved().
+	  */
+	inline bool isObservedBlock(unsigned address, unsigned areaMask) const {
+		address  &= sizeMask;
+		areaMask &= sizeMask;
+		return bitmapVisibleWindow.isObservedBlock(address, areaMask) ||
+		       spriteAttribTable  .isObservedBlock(address, areaMask) ||
+		       spritePatternTable .isObservedBlock(address, areaMask);
+	}
+
+	/** Write a byte from the command engine to a location that is not
+	  * observed (see isObservedBlock()). This skips all subsystem
+	  * synchronisation, so the write time doesn't matter.
+	  */
+	inline void cmdWriteUnobserved(unsigned address, byte value) {
+		address &= sizeMask;
+		if (unlikely(address >= actualSize)) return;
+		data[address] = value;
+	}
+
 	/** Write a byte to VRAM through the CPU interface.
 	  * @param address The address to write.
 	  * @param value The value to write.
@@ -541,7 +599,7 @@ public:
 	/** TMS99x8 VRAM can be mapped in two ways.
 	  * See implementation for more details.
 	  */
-	void change4k8kMapping(bool mapping8k);
+	void change4k8kMapping(bool mapping8k, EmuTime::param time);
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
@@ -563,9 +621,14 @@ private:
 
 		// Subsystem synchronisation should happen before the commit,
 		// to be able to draw backlog using old state.
-		bitmapVisibleWindow.notify(address, time);
-		spriteAttribTable.notify(address, time);
-		spritePatternTable.notify(address, time);
+		// Most writes (e.g. uploads while the display is disabled, or
+		// outside the sprite tables) don't need any synchronisation,
+		// for those the observed-blocks lookup is all that's needed.
+		if (isObservedAddress(address)) {
+			bitmapVisibleWindow.notify(address, time);
+			spriteAttribTable.notify(address, time);
+			spritePatternTable.notify(address, time);
+		}
 
 		data[address] = value;
 
@@ -595,6 +658,16 @@ private:
 		*/
 	}
 
+	/** Can there be an observer that needs to be notified of a write to
+	  * the given (already masked) address? See 'observedBlocks'.
+	  */
+	inline bool isObservedAddress(unsigned address) {
+		if (unlikely(windowsChanged)) updateObservedBlocks();
+		unsigned block = address / OBSERVED_BLOCK_SIZE;
+		return (observedBlocks[block / 32] >> (block % 32)) & 1;
+	}
+	void updateObservedBlocks();
+
 	void setSizeMask(EmuTime::param time);
 
 	/** VDP this VRAM belongs to.
@@ -660,6 +733,19 @@ private:
 	  */
 	bool vrMode;
 
+	/** For each block of VRAM one bit: is there a window with an
+	  * observer that (possibly) contains an address in that block?
+	  * Writes to other blocks can skip notifying the observers. This is
+	  * recalculated (lazily) after one of the windows has changed.
+	  */
+	static const unsigned OBSERVED_BLOCK_SIZE = 1024;
+	uint32_t observedBlocks[0x40000 / OBSERVED_BLOCK_SIZE / 32];
+
+	/** Set when the mask or observer of any of the windows below has
+	  * changed, iow when 'observedBlocks' has to be recalculated.
+	  */
+	bool windowsChanged;
+
 public:
 	VRAMWindow cmdReadWindow;
 	VRAMWindow cmdWriteWindow;
@@ -13,6 +13,7 @@ class MSXMotherBoard;
 class Display;
 class Setting;
 class BooleanSetting;
+namespace PNG { struct SaveOptions; }
 
 class VideoLayer : public Layer, protected Observer<Setting>
                  , private MSXEventListener
@@ -32,7 +33,8 @@ public:
 	 * parameter should be either '240' or '480'. The current image will be
 	 * scaled to '320x240' or '640x480' and written to a png file. */
 	virtual void takeRawScreenShot(
-		unsigned height, const std::string& filename) = 0;
+		unsigned height, const std::string& filename,
+		const PNG::SaveOptions& options) = 0;
 
 	// We used to test whether a Layer is active by looking at the
 	// Z-coordinate (Z_MSX_ACTIVE vs Z_MSX_PASSIVE). Though in case of
@@ -9,7 +9,8 @@ bool VideoSystem::checkSettings()
 }
 
 void VideoSystem::takeScreenShot(
-	const std::string& /*filename*/, bool /*withOsd*/)
+	const std::string& /*filename*/, bool /*withOsd*/,
+	const PNG::SaveOptions& /*options*/)
 {
 	throw MSXException(
 		"Taking screenshot not possible with current renderer.");
@@ -14,6 +14,7 @@ class LDRasterizer;
 class V9990;
 class LaserdiscPlayer;
 class OutputSurface;
+namespace PNG { struct SaveOptions; }
 
 /** Video back-end system.
   */
@@ -64,9 +65,11 @@ public:
 	  * The default implementation throws an exception.
 	  * @param filename Name of the file to save the screenshot to.
 	  * @param withOsd Should OSD elements be included in the screenshot.
+	  * @param options How to encode the PNG file.
 	  * @throws MSXException If taking the screen shot fails.
 	  */
-	virtual void takeScreenShot(const std::string& filename, bool withOsd);
+	virtual void takeScreenShot(const std::string& filename, bool withOsd,
+	                            const PNG::SaveOptions& options);
 
 	/** Called when the window title string has changed.
 	  */
@@ -1,7 +1,7 @@
 #include "V9990BitmapConverter.hh"
 #include "V9990VRAM.hh"
 #include "V9990.hh"
-#include "Math.hh"
+#include "V9990LineKernels.hh"
 #include "unreachable.hh"
 #include "build-info.hh"
 #include "components.hh"
@@ -24,31 +24,30 @@ V9990BitmapConverter<Pixel>::V9990BitmapConverter(
 	setColorMode(PP, B0); // initialize with dummy values
 }
 
-template<bool YJK, bool PAL, bool SKIP, typename Pixel, typename ColorLookup>
-static inline void draw_YJK_YUV_PAL(
-	ColorLookup color, V9990VRAM& vram,
-	Pixel* __restrict out, unsigned& address, int firstX = 0)
-{
-	byte data[4];
-	for (auto& d : data) {
-		d = vram.readVRAMBx(address++);
-	}
-
-	int u = (data[2] & 7) + ((data[3] & 3) << 3) - ((data[3] & 4) << 3);
-	int v = (data[0] & 7) + ((data[1] & 3) << 3) - ((data[1] & 4) << 3);
+// Buffer sizes for one display line, see assert in convertLine().
+static const unsigned MAX_PIXELS = 1024;
 
-	for (int i = SKIP ? firstX : 0; i < 4; ++i) {
-		if (PAL && (data[i] & 0x08)) {
-			*out++ = color.lookup64(data[i] >> 4);
+template<bool YJK, bool PAL, typename Pixel, typename ColorLookup>
+static void rasterYJK_YUV(
+	ColorLookup color, V9990& vdp, V9990VRAM& vram,
+	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
+{
+	assert(nrPixels > 0);
+	// Always convert complete groups of 4 pixels (they share the U and V
+	// components), skip the first (x & 3) pixels of the first group.
+	unsigned first = x & 3;
+	unsigned numGroups = (first + nrPixels + 3) / 4;
+	byte data[MAX_PIXELS + 4];
+	uint16_t idx[MAX_PIXELS + 4];
+	vram.readVRAMBxSpan((x & ~3) + y * vdp.getImageWidth(),
+	                    data, 4 * numGroups);
+	V9990LineKernels::yuvToIndex<YJK>(idx, data, numGroups);
+	for (int i = 0; i < nrPixels; ++i) {
+		unsigned j = first + i;
+		if (PAL && (data[j] & 0x08)) {
+			out[i] = color.lookup64(data[j] >> 4);
 		} else {
-			int y = (data[i] & 0xF8) >> 3;
-			int r = Math::clip<0, 31>(y + u);
-			int g = Math::clip<0, 31>((5 * y - 2 * u - v) / 4);
-			int b = Math::clip<0, 31>(y + v);
-			// The only difference between YUV and YJK is that
-			// green and blue are swapped.
-			if (YJK) std::swap(g, b);
-			*out++ = color.lookup32768((g << 10) + (r << 5) + b);
+			out[i] = color.lookup32768(idx[j]);
 		}
 	}
 }
@@ -58,17 +57,7 @@ static void rasterBYUV(
 	ColorLookup color, V9990& vdp, V9990VRAM& vram,
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
-	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<false, false, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
-	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<false, false, false>(
-			color, vram, out, address);
-	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
+	rasterYJK_YUV<false, false>(color, vdp, vram, out, x, y, nrPixels);
 }
 
 template<typename Pixel, typename ColorLookup>
@@ -78,17 +67,7 @@ static void rasterBYUVP(
 {
 	// TODO this mode cannot be shown in B4 and higher resolution modes
 	//      (So the dual palette for B4 modes is not an issue here.)
-	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<false, true, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
-	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<false, true, false>(
-			color, vram, out, address);
-	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
+	rasterYJK_YUV<false, true>(color, vdp, vram, out, x, y, nrPixels);
 }
 
 template<typename Pixel, typename ColorLookup>
@@ -96,17 +75,7 @@ static void rasterBYJK(
 	ColorLookup color, V9990& vdp, V9990VRAM& vram,
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
-	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<true, false, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
-	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<true, false, false>(
-			color, vram, out, address);
-	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
+	rasterYJK_YUV<true, false>(color, vdp, vram, out, x, y, nrPixels);
 }
 
 template<typename Pixel, typename ColorLookup>
@@ -116,17 +85,7 @@ static void rasterBYJKP(
 {
 	// TODO this mode cannot be shown in B4 and higher resolution modes
 	//      (So the dual palette for B4 modes is not an issue here.)
-	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<true, true, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
-	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<true, true, false>(
-			color, vram, out, address);
-	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
+	rasterYJK_YUV<true, true>(color, vdp, vram, out, x, y, nrPixels);
 }
 
 template<typename Pixel, typename ColorLookup>
@@ -134,25 +93,23 @@ static void rasterBD16(
 	ColorLookup color, V9990& vdp, V9990VRAM& vram,
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
-	unsigned address = 2 * (x + y * vdp.getImageWidth());
+	assert(nrPixels > 0);
+	byte data[2 * MAX_PIXELS];
+	vram.readVRAMBxSpan(2 * (x + y * vdp.getImageWidth()),
+	                    data, 2 * nrPixels);
 	if (vdp.isSuperimposing()) {
 		auto transparant = color.lookup256(0);
-		for (/**/; nrPixels > 0; --nrPixels) {
-			byte high = vram.readVRAMBx(address + 1);
-			if (high & 0x80) {
-				*out = transparant;
-			} else {
-				byte low  = vram.readVRAMBx(address + 0);
-				*out = color.lookup32768(low + 256 * high);
-			}
-			address += 2;
-			out += 1;
+		for (int i = 0; i < nrPixels; ++i) {
+			byte low  = data[2 * i + 0];
+			byte high = data[2 * i + 1];
+			out[i] = (high & 0x80) ? transparant
+			                       : color.lookup32768(low + 256 * high);
 		}
 	} else {
-		for (/**/; nrPixels > 0; --nrPixels) {
-			byte low  = vram.readVRAMBx(address++);
-			byte high = vram.readVRAMBx(address++);
-			*out++ = color.lookup32768((low + 256 * high) & 0x7FFF);
+		for (int i = 0; i < nrPixels; ++i) {
+			byte low  = data[2 * i + 0];
+			byte high = data[2 * i + 1];
+			out[i] = color.lookup32768((low + 256 * high) & 0x7FFF);
 		}
 	}
 }
@@ -162,9 +119,11 @@ static void rasterBD8(
 	ColorLookup color, V9990& vdp, V9990VRAM& vram,
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
-	unsigned address = x + y * vdp.getImageWidth();
-	for (/**/; nrPixels > 0; --nrPixels) {
-		*out++ = color.lookup256(vram.readVRAMBx(address++));
+	assert(nrPixels > 0);
+	byte data[MAX_PIXELS];
+	vram.readVRAMBxSpan(x + y * vdp.getImageWidth(), data, nrPixels);
+	for (int i = 0; i < nrPixels; ++i) {
+		out[i] = color.lookup256(data[i]);
 	}
 }
 
@@ -173,9 +132,11 @@ static void rasterBP6(
 	ColorLookup color, V9990& vdp, V9990VRAM& vram,
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
-	unsigned address = x + y * vdp.getImageWidth();
-	for (/**/; nrPixels > 0; --nrPixels) {
-		*out++ = color.lookup64(vram.readVRAMBx(address++) & 0x3F);
+	assert(nrPixels > 0);
+	byte data[MAX_PIXELS];
+	vram.readVRAMBxSpan(x + y * vdp.getImageWidth(), data, nrPixels);
+	for (int i = 0; i < nrPixels; ++i) {
+		out[i] = color.lookup64(data[i] & 0x3F);
 	}
 }
 
@@ -185,15 +146,18 @@ static void rasterBP4(
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
 	assert(nrPixels > 0);
-	unsigned address = (x + y * vdp.getImageWidth()) / 2;
+	byte buf[MAX_PIXELS / 2 + 1];
+	vram.readVRAMBxSpan((x + y * vdp.getImageWidth()) / 2,
+	                    buf, ((x & 1) + nrPixels + 1) / 2);
+	const byte* d = buf;
 	color.set64Offset((vdp.getPaletteOffset() & 0xC) << 2);
 	if (x & 1) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		*out++ = color.lookup64(data & 0x0F);
 		--nrPixels;
 	}
 	for (/**/; nrPixels > 0; nrPixels -= 2) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		*out++ = color.lookup64(data >> 4);
 		*out++ = color.lookup64(data & 0x0F);
 	}
@@ -207,15 +171,19 @@ static void rasterBP4HiRes(
 	// Verified on real HW:
 	//   Bit PLT05 in palette offset is ignored, instead for even pixels
 	//   bit 'PLT05' is '0', for odd pixels it's '1'.
-	unsigned address = (x + y * vdp.getImageWidth()) / 2;
+	assert(nrPixels > 0);
+	byte buf[MAX_PIXELS / 2 + 1];
+	vram.readVRAMBxSpan((x + y * vdp.getImageWidth()) / 2,
+	                    buf, ((x & 1) + nrPixels + 1) / 2);
+	const byte* d = buf;
 	color.set64Offset((vdp.getPaletteOffset() & 0x4) << 2);
 	if (x & 1) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		*out++ = color.lookup64(32 | (data & 0x0F));
 		--nrPixels;
 	}
 	for (/**/; nrPixels > 0; nrPixels -= 2) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		*out++ = color.lookup64( 0 | (data >> 4  ));
 		*out++ = color.lookup64(32 | (data & 0x0F));
 	}
@@ -228,17 +196,20 @@ static void rasterBP2(
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
 	assert(nrPixels > 0);
-	unsigned address = (x + y * vdp.getImageWidth()) / 4;
+	byte buf[MAX_PIXELS / 4 + 1];
+	vram.readVRAMBxSpan((x + y * vdp.getImageWidth()) / 4,
+	                    buf, ((x & 3) + nrPixels + 3) / 4);
+	const byte* d = buf;
 	color.set64Offset(vdp.getPaletteOffset() << 2);
 	if (x & 3) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		if ((x & 3) <= 1) *out++ = color.lookup64((data & 0x30) >> 4);
 		if ((x & 3) <= 2) *out++ = color.lookup64((data & 0x0C) >> 2);
 		if (true)         *out++ = color.lookup64((data & 0x03) >> 0);
 		nrPixels -= 4 - (x & 3);
 	}
 	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		*out++ = color.lookup64((data & 0xC0) >> 6);
 		*out++ = color.lookup64((data & 0x30) >> 4);
 		*out++ = color.lookup64((data & 0x0C) >> 2);
@@ -255,17 +226,20 @@ static void rasterBP2HiRes(
 	//   Bit PLT05 in palette offset is ignored, instead for even pixels
 	//   bit 'PLT05' is '0', for odd pixels it's '1'.
 	assert(nrPixels > 0);
-	unsigned address = (x + y * vdp.getImageWidth()) / 4;
+	byte buf[MAX_PIXELS / 4 + 1];
+	vram.readVRAMBxSpan((x + y * vdp.getImageWidth()) / 4,
+	                    buf, ((x & 3) + nrPixels + 3) / 4);
+	const byte* d = buf;
 	color.set64Offset((vdp.getPaletteOffset() & 0x7) << 2);
 	if (x & 3) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		if ((x & 3) <= 1) *out++ = color.lookup64(32 | ((data & 0x30) >> 4));
 		if ((x & 3) <= 2) *out++ = color.lookup64( 0 | ((data & 0x0C) >> 2));
 		if (true)         *out++ = color.lookup64(32 | ((data & 0x03) >> 0));
 		nrPixels -= 4 - (x & 3);
 	}
 	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		byte data = vram.readVRAMBx(address++);
+		byte data = *d++;
 		*out++ = color.lookup64( 0 | ((data & 0xC0) >> 6));
 		*out++ = color.lookup64(32 | ((data & 0x30) >> 4));
 		*out++ = color.lookup64( 0 | ((data & 0x0C) >> 2));
@@ -442,14 +416,14 @@ void V9990BitmapConverter<Pixel>::convertLine(
 	Pixel* linePtr, unsigned x, unsigned y, int nrPixels,
 	int cursorY, bool drawCursors)
 {
-	assert(nrPixels <= 1024);
+	assert(nrPixels <= int(MAX_PIXELS));
 
 	CursorInfo cursor0(vdp, vram, palette64_32768, 0x7fe00, 0x7ff00, cursorY, drawCursors);
 	CursorInfo cursor1(vdp, vram, palette64_32768, 0x7fe08, 0x7ff80, cursorY, drawCursors);
 
 	if (cursor0.isVisible() || cursor1.isVisible()) {
 		// raster background into a temporary buffer
-		int16_t buf[1024];
+		int16_t buf[MAX_PIXELS];
 		raster(colorMode, highRes,
 		       IndexLookup(palette64_32768, palette256_32768),
 		       vdp, vram,
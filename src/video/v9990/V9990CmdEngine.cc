@@ -11,6 +11,8 @@
 #include "serialize.hh"
 #include "likely.hh"
 #include "unreachable.hh"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 
 namespace openmsx {
@@ -927,6 +929,18 @@ EmuDuration V9990CmdEngine::getTiming(const unsigned table[4][3][4]) const
 	return Clock<V9990DisplayTiming::UC_TICKS_PER_SECOND>::duration(x);
 }
 
+unsigned V9990CmdEngine::getNumSteps(
+	EmuTime::param limit, EmuDuration::param delta, unsigned max) const
+{
+	// Each step first advances 'engineTime' and then does its work, so
+	// a step can start as long as 'engineTime' hasn't reached 'limit'.
+	if (engineTime >= limit) return 0;
+	uint64_t d = delta.length();
+	if (d == 0) return max; // broken timing: everything happens at once
+	uint64_t steps = ((limit - engineTime).length() + d - 1) / d;
+	return unsigned(std::min<uint64_t>(steps, max));
+}
+
 
 // STOP
 void V9990CmdEngine::startSTOP(EmuTime::param time)
@@ -1020,19 +1034,23 @@ void V9990CmdEngine::startLMMV(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMV(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(LMMV_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
-
-		DX += dx;
-		if (!--(ANX)) {
+	unsigned steps = getNumSteps(limit, delta, getRemainingPixels());
+	while (steps) {
+		// (rest of) one row, without a time check per pixel
+		unsigned n = std::min<unsigned>(steps, ANX);
+		steps -= n;
+		ANX -= n;
+		engineTime += delta * n;
+		for (unsigned i = 0; i < n; ++i) {
+			Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
+			DX += dx;
+		}
+		if (!ANX) {
 			DX -= (NX * dx);
 			DY += dy;
 			if (!--(ANY)) {
@@ -1112,22 +1130,26 @@ void V9990CmdEngine::startLMMM(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMM(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(LMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		auto src = Mode::point(vram, SX, SY, pitch);
-		src = Mode::shift(src, SX, DX);
-		Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
-
-		DX += dx;
-		SX += dx;
-		if (!--(ANX)) {
+	unsigned steps = getNumSteps(limit, delta, getRemainingPixels());
+	while (steps) {
+		// (rest of) one row, without a time check per pixel
+		unsigned n = std::min<unsigned>(steps, ANX);
+		steps -= n;
+		ANX -= n;
+		engineTime += delta * n;
+		for (unsigned i = 0; i < n; ++i) {
+			auto src = Mode::point(vram, SX, SY, pitch);
+			src = Mode::shift(src, SX, DX);
+			Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
+			DX += dx;
+			SX += dx;
+		}
+		if (!ANX) {
 			DX -= (NX * dx);
 			SX -= (NX * dx);
 			DY += dy;
@@ -1207,28 +1229,32 @@ void V9990CmdEngine::startCMMM(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeCMMM(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(CMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		if (!bitsLeft) {
-			data = vram.readVRAMBx(srcAddress++);
-			bitsLeft = 8;
-		}
-		--bitsLeft;
-		bool bit = (data & 0x80) != 0;
-		data <<= 1;
-
-		word color = bit ? fgCol : bgCol;
-		Mode::psetColor(vram, DX, DY, pitch, color, WM, lut, LOG);
+	unsigned steps = getNumSteps(limit, delta, getRemainingPixels());
+	while (steps) {
+		// (rest of) one row, without a time check per pixel
+		unsigned n = std::min<unsigned>(steps, ANX);
+		steps -= n;
+		ANX -= n;
+		engineTime += delta * n;
+		for (unsigned i = 0; i < n; ++i) {
+			if (!bitsLeft) {
+				data = vram.readVRAMBx(srcAddress++);
+				bitsLeft = 8;
+			}
+			--bitsLeft;
+			bool bit = (data & 0x80) != 0;
+			data <<= 1;
 
-		DX += dx;
-		if (!--(ANX)) {
+			word color = bit ? fgCol : bgCol;
+			Mode::psetColor(vram, DX, DY, pitch, color, WM, lut, LOG);
+			DX += dx;
+		}
+		if (!ANX) {
 			DX -= (NX * dx);
 			DY += dy;
 			if (!--(ANY)) {
@@ -1260,14 +1286,21 @@ void V9990CmdEngine::executeBMXL<V9990CmdEngine::V9990Bpp16>(EmuTime::param limi
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = V9990Bpp16::getLogOpLUT(LOG);
 
-	while (engineTime < limit) {
-		engineTime += delta;
-		word src = vram.readVRAMBx(srcAddress + 0) +
-		           vram.readVRAMBx(srcAddress + 1) * 256;
-		srcAddress += 2;
-		V9990Bpp16::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
-		DX += dx;
-		if (!--(ANX)) {
+	unsigned steps = getNumSteps(limit, delta, getRemainingPixels());
+	while (steps) {
+		// (rest of) one row, without a time check per pixel
+		unsigned n = std::min<unsigned>(steps, ANX);
+		steps -= n;
+		ANX -= n;
+		engineTime += delta * n;
+		for (unsigned i = 0; i < n; ++i) {
+			word src = vram.readVRAMBx(srcAddress + 0) +
+			           vram.readVRAMBx(srcAddress + 1) * 256;
+			srcAddress += 2;
+			V9990Bpp16::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
+			DX += dx;
+		}
+		if (!ANX) {
 			DX -= (NX * dx);
 			DY += dy;
 			if (!--(ANY)) {
@@ -1395,8 +1428,10 @@ void V9990CmdEngine::executeBMLL<V9990CmdEngine::V9990Bpp16>(EmuTime::param limi
 	auto delta = getTiming(BMLL_TIMING) * 2;
 	const byte* lut = V9990Bpp16::getLogOpLUT(LOG);
 	bool transp = (LOG & 0x10) != 0;
-	while (engineTime < limit) {
-		engineTime += delta;
+	unsigned steps = getNumSteps(limit, delta, nbBytes);
+	engineTime += delta * steps;
+	nbBytes -= steps;
+	for (unsigned i = 0; i < steps; ++i) {
 		// VRAM always mapped as in Bx modes
 		word srcColor = vram.readVRAMDirect(srcAddress + 0x00000) +
 		                vram.readVRAMDirect(srcAddress + 0x40000) * 256;
@@ -1408,10 +1443,9 @@ void V9990CmdEngine::executeBMLL<V9990CmdEngine::V9990Bpp16>(EmuTime::param limi
 		vram.writeVRAMDirect(dstAddress + 0x40000, result >> 8);
 		srcAddress = (srcAddress + 1) & 0x3FFFF;
 		dstAddress = (dstAddress + 1) & 0x3FFFF;
-		if (!--nbBytes) {
-			cmdReady(engineTime);
-			return;
-		}
+	}
+	if (!nbBytes) {
+		cmdReady(engineTime);
 	}
 }
 
@@ -1421,8 +1455,10 @@ void V9990CmdEngine::executeBMLL(EmuTime::param limit)
 	// TODO DIX DIY?
 	auto delta = getTiming(BMLL_TIMING);
 	const byte* lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
+	unsigned steps = getNumSteps(limit, delta, nbBytes);
+	engineTime += delta * steps;
+	nbBytes -= steps;
+	for (unsigned i = 0; i < steps; ++i) {
 		// VRAM always mapped as in Bx modes
 		byte srcColor = vram.readVRAMBx(srcAddress);
 		unsigned addr = V9990VRAM::transformBx(dstAddress);
@@ -1433,10 +1469,9 @@ void V9990CmdEngine::executeBMLL(EmuTime::param limit)
 		vram.writeVRAMDirect(addr, result);
 		srcAddress = (srcAddress + 1) & 0x7FFFF;
 		dstAddress = (dstAddress + 1) & 0x7FFFF;
-		if (!--nbBytes) {
-			cmdReady(engineTime);
-			return;
-		}
+	}
+	if (!nbBytes) {
+		cmdReady(engineTime);
 	}
 }
 
@@ -315,6 +315,21 @@ private:
 	void setCommandMode();
 	EmuDuration getTiming(const unsigned table[4][3][4]) const;
 
+	/** The number of steps of length 'delta' the engine can still start
+	  * before 'limit', clipped to 'max'. This allows the execute methods
+	  * to process whole rows (or the whole remaining rectangle) without
+	  * checking the time after every pixel.
+	  */
+	unsigned getNumSteps(EmuTime::param limit, EmuDuration::param delta,
+	                     unsigned max) const;
+
+	/** The number of pixels the current rectangle command still has to
+	  * process (the rest of the current row plus all following rows).
+	  */
+	inline unsigned getRemainingPixels() const {
+		return ANX + (ANY - 1) * getWrappedNX();
+	}
+
 	inline unsigned getWrappedNX() const {
 		return NX ? NX : 2048;
 	}
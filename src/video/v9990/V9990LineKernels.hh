@@ -0,0 +1,146 @@
+#ifndef V9990LINEKERNELS_HH
+#define V9990LINEKERNELS_HH
+
+#include "openmsx.hh"
+#include "Math.hh"
+#include <cstdint>
+#include <utility>
+#ifdef __SSE2__
+#include "emmintrin.h" // SSE2
+#endif
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace openmsx {
+
+/** Helper routines for the V9990 line converters that work on a whole
+  * (part of a) display line at once instead of pixel per pixel.
+  */
+namespace V9990LineKernels {
+
+/** Merge two byte streams: out = even[0], odd[0], even[1], odd[1], ...
+  * In Bx modes the even VRAM addresses are stored in the first half of
+  * the V9990 VRAM and the odd addresses in the second half, so this turns
+  * two linear runs from those halves into a linear run of Bx bytes.
+  * Writes 2 * num bytes.
+  */
+inline void interleave(byte* __restrict out, const byte* __restrict even,
+                       const byte* __restrict odd, unsigned num)
+{
+	unsigned i = 0;
+#if defined(__SSE2__)
+	for (; (i + 16) <= num; i += 16) {
+		__m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(even + i));
+		__m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(odd  + i));
+		auto* d = reinterpret_cast<__m128i*>(out + 2 * i);
+		_mm_storeu_si128(d + 0, _mm_unpacklo_epi8(e, o));
+		_mm_storeu_si128(d + 1, _mm_unpackhi_epi8(e, o));
+	}
+#elif defined(__ARM_NEON)
+	for (; (i + 16) <= num; i += 16) {
+		uint8x16x2_t v = {{ vld1q_u8(even + i), vld1q_u8(odd + i) }};
+		vst2q_u8(out + 2 * i, v);
+	}
+#endif
+	for (; i < num; ++i) {
+		out[2 * i + 0] = even[i];
+		out[2 * i + 1] = odd [i];
+	}
+}
+
+/** Convert YUV (or YJK) encoded bitmap data to indices in the 32768
+  * color V9990 palette (format GGGGGRRRRRBBBBB). The input consists of
+  * groups of 4 bytes, each group produces 4 indices.
+  * In the YUVP/YJKP modes the pixels that use the 64 color palette also
+  * get an index, the caller has to replace those.
+  */
+template<bool YJK>
+inline void yuvToIndex(uint16_t* __restrict out, const byte* __restrict in,
+                       unsigned numGroups)
+{
+	unsigned i = 0;
+#ifdef __SSE2__
+	// 2 groups (8 pixels, one 16-bit lane per pixel) per iteration.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c7   = _mm_set1_epi16(7);
+	const __m128i c31  = _mm_set1_epi16(31);
+	for (; (i + 2) <= numGroups; i += 2) {
+		__m128i d = _mm_unpacklo_epi8(
+			_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + 4 * i)),
+			zero);
+		// Lane 0 (and 4) gets the 6-bit V value, lane 2 (and 6) gets U.
+		__m128i k = _mm_and_si128(d, c7);
+		__m128i w = _mm_or_si128(k, _mm_slli_epi16(_mm_srli_si128(k, 2), 3));
+		w = _mm_srai_epi16(_mm_slli_epi16(w, 10), 10); // sign extend
+		__m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(w,
+			_MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+		__m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(w,
+			_MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 2, 2, 2));
+		__m128i y = _mm_srli_epi16(d, 3);
+
+		// Note: the arithmetic shift rounds towards -infinity instead of
+		// towards zero (like '/ 4' does). That only makes a difference
+		// for negative values, which get clipped to 0 anyway.
+		__m128i r = _mm_add_epi16(y, u);
+		__m128i g = _mm_srai_epi16(_mm_sub_epi16(_mm_sub_epi16(
+			_mm_add_epi16(_mm_slli_epi16(y, 2), y),
+			_mm_slli_epi16(u, 1)), v), 2);
+		__m128i b = _mm_add_epi16(y, v);
+		r = _mm_min_epi16(_mm_max_epi16(r, zero), c31);
+		g = _mm_min_epi16(_mm_max_epi16(g, zero), c31);
+		b = _mm_min_epi16(_mm_max_epi16(b, zero), c31);
+		// The only difference between YUV and YJK is that green and
+		// blue are swapped.
+		if (YJK) std::swap(g, b);
+		__m128i idx = _mm_or_si128(_mm_or_si128(
+			_mm_slli_epi16(g, 10), _mm_slli_epi16(r, 5)), b);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i), idx);
+	}
+#endif
+	for (; i < numGroups; ++i) {
+		const byte* data = in + 4 * i;
+		int u = (data[2] & 7) + ((data[3] & 3) << 3) - ((data[3] & 4) << 3);
+		int v = (data[0] & 7) + ((data[1] & 3) << 3) - ((data[1] & 4) << 3);
+		for (int j = 0; j < 4; ++j) {
+			int y = (data[j] & 0xF8) >> 3;
+			int r = Math::clip<0, 31>(y + u);
+			int g = Math::clip<0, 31>((5 * y - 2 * u - v) / 4);
+			int b = Math::clip<0, 31>(y + v);
+			if (YJK) std::swap(g, b);
+			out[4 * i + j] = (g << 10) + (r << 5) + b;
+		}
+	}
+}
+
+/** Draw 'num' P1/P2 pattern rows of 8 pixels. Each pattern row is packed
+  * in a 32-bit word, the leftmost pixel in the upper 4 bits. Color 0 is
+  * transparent (the destination pixel is left unchanged).
+  * Completely transparent and completely opaque pattern rows are by far
+  * the most common, they are handled without per-pixel tests.
+  */
+template<typename Pixel>
+inline void drawTiles(Pixel* __restrict out, const uint32_t* __restrict patterns,
+                      unsigned num, const Pixel* __restrict palette)
+{
+	for (unsigned t = 0; t < num; ++t, out += 8) {
+		uint32_t p = patterns[t];
+		if (p == 0) continue;
+		if (((p - 0x11111111) & ~p & 0x88888888) == 0) {
+			// no zero nibbles
+			for (int i = 0; i < 8; ++i) {
+				out[i] = palette[(p >> (28 - 4 * i)) & 15];
+			}
+		} else {
+			for (int i = 0; i < 8; ++i) {
+				unsigned c = (p >> (28 - 4 * i)) & 15;
+				if (c) out[i] = palette[c];
+			}
+		}
+	}
+}
+
+} // namespace V9990LineKernels
+} // namespace openmsx
+
+#endif
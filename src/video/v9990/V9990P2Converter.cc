@@ -1,5 +1,6 @@
 #include "V9990P2Converter.hh"
 #include "V9990VRAM.hh"
+#include "V9990LineKernels.hh"
 #include "V9990.hh"
 #include "MemoryOps.hh"
 #include "build-info.hh"
@@ -93,39 +94,26 @@ void V9990P2Converter<Pixel>::renderPattern(
 	}
 	assert((x & 7) == 0 || (width == 0));
 	while (width & ~7) {
-		unsigned patternNum = (vram.readVRAMDirect(nameAddr + 0) +
-		                       vram.readVRAMDirect(nameAddr + 1) * 256) & 0x1FFF;
-		unsigned x2 = (patternNum % 64) * 4;
-		unsigned y2 = (patternNum / 64) * 2048 + y;
-		unsigned address = patternTable + y2 + x2;
-
-		byte data0 = vram.readVRAMBx(address + 0);
-		byte p0 = data0 >> 4;
-		if (p0) buffer[0] = palette[p0];
-		byte p1 = data0 & 0x0F;
-		if (p1) buffer[1] = palette[p1];
-
-		byte data1 = vram.readVRAMBx(address + 1);
-		byte p2 = data1 >> 4;
-		if (p2) buffer[2] = palette[p2];
-		byte p3 = data1 & 0x0F;
-		if (p3) buffer[3] = palette[p3];
-
-		byte data2 = vram.readVRAMBx(address + 2);
-		byte p4 = data2 >> 4;
-		if (p4) buffer[4] = palette[p4];
-		byte p5 = data2 & 0x0F;
-		if (p5) buffer[5] = palette[p5];
-
-		byte data3 = vram.readVRAMBx(address + 3);
-		byte p6 = data3 >> 4;
-		if (p6) buffer[6] = palette[p6];
-		byte p7 = data3 & 0x0F;
-		if (p7) buffer[7] = palette[p7];
-
-		width -= 8;
-		buffer += 8;
-		nameAddr = (nameAddr & ~255) | ((nameAddr + 2) & 255);
+		// First fetch the pattern data for a run of complete 8-pixel
+		// tiles, then draw them all in one go.
+		static const unsigned MAX_TILES = 128;
+		uint32_t patterns[MAX_TILES];
+		unsigned numTiles = std::min(width / 8, MAX_TILES);
+		for (unsigned t = 0; t < numTiles; ++t) {
+			unsigned patternNum = (vram.readVRAMDirect(nameAddr + 0) +
+			                       vram.readVRAMDirect(nameAddr + 1) * 256) & 0x1FFF;
+			unsigned x2 = (patternNum % 64) * 4;
+			unsigned y2 = (patternNum / 64) * 2048 + y;
+			unsigned address = patternTable + y2 + x2;
+			patterns[t] = (uint32_t(vram.readVRAMBx(address + 0)) << 24) |
+			              (vram.readVRAMBx(address + 1) << 16) |
+			              (vram.readVRAMBx(address + 2) <<  8) |
+			              (vram.readVRAMBx(address + 3) <<  0);
+			nameAddr = (nameAddr & ~255) | ((nameAddr + 2) & 255);
+		}
+		V9990LineKernels::drawTiles(buffer, patterns, numTiles, palette);
+		width  -= 8 * numTiles;
+		buffer += 8 * numTiles;
 	}
 	assert(width < 8);
 	if (width) {
@@ -80,7 +80,8 @@ void V9990PixelRenderer::frameStart(EmuTime::param time)
 			drawFrame = true;
 		} else {
 			++frameSkipCounter;
-			if (rasterizer->isRecording()) {
+			if (rasterizer->isRecording() ||
+			    renderSettings.getFrameHash()) {
 				drawFrame = true;
 			} else {
 				drawFrame = realTime.timeLeft(
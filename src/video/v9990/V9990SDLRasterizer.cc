@@ -7,7 +7,7 @@
 #include "StringSetting.hh"
 #include "MSXMotherBoard.hh"
 #include "Display.hh"
-#include "VisibleSurface.hh"
+#include "OutputSurface.hh"
 #include "RenderSettings.hh"
 #include "MemoryOps.hh"
 #include "build-info.hh"
@@ -23,7 +23,7 @@ namespace openmsx {
 
 template <class Pixel>
 V9990SDLRasterizer<Pixel>::V9990SDLRasterizer(
-		V9990& vdp_, Display& display, VisibleSurface& screen_,
+		V9990& vdp_, Display& display, OutputSurface& screen_,
 		std::unique_ptr<PostProcessor> postProcessor_)
 	: vdp(vdp_), vram(vdp.getVRAM())
 	, screen(screen_)
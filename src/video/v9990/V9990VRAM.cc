@@ -1,6 +1,8 @@
 #include "V9990.hh"
 #include "V9990VRAM.hh"
+#include "V9990LineKernels.hh"
 #include "serialize.hh"
+#include <algorithm>
 #include <cstring>
 
 namespace openmsx {
@@ -51,6 +53,31 @@ void V9990VRAM::writeVRAMCPU(unsigned address, byte value, EmuTime::param time)
 	data.write(mapAddress(address), value);
 }
 
+void V9990VRAM::readVRAMBxSpan(unsigned address, byte* out, unsigned num)
+{
+	address &= 0x7FFFF;
+	if ((address & 1) && num) {
+		*out++ = readVRAMBx(address);
+		address = (address + 1) & 0x7FFFF;
+		--num;
+	}
+	// The even bytes are stored in the first half of VRAM, the odd bytes
+	// in the second half. Copy pairs until the end of a half is reached.
+	const byte* even = &data[0];
+	const byte* odd  = &data[0x40000];
+	while (num >= 2) {
+		unsigned half = address / 2;
+		unsigned pairs = std::min(num / 2, 0x40000 - half);
+		V9990LineKernels::interleave(out, even + half, odd + half, pairs);
+		out += 2 * pairs;
+		num -= 2 * pairs;
+		address = (address + 2 * pairs) & 0x7FFFF;
+	}
+	if (num) {
+		*out = readVRAMBx(address);
+	}
+}
+
 template<typename Archive>
 void V9990VRAM::serialize(Archive& ar, unsigned /*version*/)
 {
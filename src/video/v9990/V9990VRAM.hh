@@ -71,6 +71,13 @@ public:
 		data.write(transformP2(address), value);
 	}
 
+	/** Read 'num' consecutive Bx-mode bytes starting at 'address' (wraps
+	  * at the end of VRAM). Equivalent to calling readVRAMBx() for each
+	  * address, but much faster for the long runs the bitmap converter
+	  * reads per display line.
+	  */
+	void readVRAMBxSpan(unsigned address, byte* out, unsigned num);
+
 	inline byte readVRAMDirect(unsigned address) {
 		return data[address];
 	}
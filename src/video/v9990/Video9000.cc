@@ -123,13 +123,14 @@ void Video9000::paint(OutputSurface& output)
 	activeLayer->paint(output);
 }
 
-void Video9000::takeRawScreenShot(unsigned height, const std::string& filename)
+void Video9000::takeRawScreenShot(unsigned height, const std::string& filename,
+                                  const PNG::SaveOptions& options)
 {
 	auto* layer = dynamic_cast<VideoLayer*>(activeLayer);
 	if (!layer) {
 		throw CommandException("TODO");
 	}
-	layer->takeRawScreenShot(height, filename);
+	layer->takeRawScreenShot(height, filename, options);
 }
 
 int Video9000::signalEvent(const std::shared_ptr<const Event>& event)